@@ -1,10 +1,18 @@
 ﻿#pragma once
 
+#include <queue>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <optional>
 #include <shared_mutex>
 #include <unordered_set>
 #include <filesystem>
 
 #include "statistics.hpp"
+#include "history.hpp"
+#include "mpsc.hpp"
+#include "utils.hpp"
 #include "logger.hpp"
 #include "state.hpp"
 
@@ -18,14 +26,116 @@ namespace Logwatch {
 		Snapshot mods, backup;
 		std::unordered_set<std::string> pinned;
 
+		// Recent records per mod (same keys as mods). Mutable because the const readers
+		// normalize text in place the first time it's shown.
+		using History = std::unordered_map<std::string, ModHistory>;
+		mutable History history;
+		History historyBackup;
+
+		// Min-heap on each non-empty mod's oldest seq, for evicting across mods when the
+		// text goes over budget. Keys can lag behind (the ring evicts on its own), never
+		// run ahead. Map nodes don't move, so pointers are fine until an erase, and
+		// everything that erases calls requeue().
+		struct Oldest {
+			uint64_t    seq;
+			ModHistory* mod;
+			inline bool operator>(const Oldest& o) const { return seq > o.seq; }
+		};
+		std::priority_queue<Oldest, std::vector<Oldest>, std::greater<>> oldest;
+		uint64_t nextSeq = 0;
+		size_t   textBytes = 0;  // sum of history[*].text.bytes()
+
 		// To remind myself, I added mutable to allow unlocking in constant functions.
 		mutable std::shared_mutex _mutex_;
 
-		// Cache capacity.
+		// Cache capacity (records per mod) and byte budget for record text (all mods).
 		std::atomic_size_t cap;
+		std::atomic_size_t budget{ MB2B(64) };
+
+		// Matches land here first and get applied in batches, so a burst costs one
+		// exclusive lock per batch instead of one per match. commit() is the only consumer.
+		static constexpr size_t kInboxSize = 4096;
+		MpscQueue<Match>   inbox{ kInboxSize };
+		std::vector<Match> batch;
+		std::mutex         _commit_mutex_;
+
+		// Matches applied per exclusive lock; 1 is the old lock-per-match behaviour, for
+		// comparing the lock stats below.
+		std::atomic_size_t batchLimit{ kInboxSize };
+
+		// How long commit() holds the exclusive lock.
+		std::atomic<uint64_t> commits{ 0 };
+		std::atomic<uint64_t> committed{ 0 };
+		std::atomic<uint64_t> holdNs{ 0 };
+		std::atomic<uint64_t> maxHoldNs{ 0 };
+
+		// Bumped under the unique lock by everything that changes mods or history, so a
+		// published snapshot knows whether it's still current.
+		std::atomic<uint64_t> version{ 1 };
+
+		// Version of the last change that removed mods or touched all of them; whoever
+		// asks for changes from before that has to start over.
+		uint64_t resetAt = 0;
+
+		struct Published {
+			uint64_t    version = 0;
+			uint64_t    resetAt = 0;
+			CountsTable table;
+		};
+
+		// Readers share the last one built; old ones go away with their last reader.
+		mutable std::atomic<std::shared_ptr<const Published>> published;
+
+		std::shared_ptr<const Published> publish() const;
+		ModCounts countsOf(const std::string& modKey, const ModStats& s) const;
+		std::shared_ptr<const Published> current() const {
+			auto p = published.load(std::memory_order_acquire);
+			if (!p || p->version != version.load(std::memory_order_acquire)) p = publish();
+			return p;
+		}
+
+		// Writers hold the unique lock: stamp what they change with nextVersion(), then touch().
+		inline uint64_t nextVersion() const { return version.load(std::memory_order_relaxed) + 1; }
+		inline void touch() { version.fetch_add(1, std::memory_order_release); }
+		inline void touchAll() {
+			resetAt = nextVersion();
+			touch();
+		}
+
+		// Sum of every mod's hash, kept up to date by whatever changes counts. A sum doesn't
+		// care about map order, and a mod's old share comes back out with one subtraction.
+		// Starts at the offset so an empty aggregator still hashes to something non zero.
+		static constexpr uint64_t FNV_OFFSET = 1469598103934665603ull;
+		static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+		std::atomic<uint64_t> rolling{ FNV_OFFSET };
+		uint64_t rollingBackup = FNV_OFFSET;
 
-		// This version is faster than the standard stem.
-		inline std::string keyOfFast(const std::string_view& path) {
+		static uint64_t hashName(const std::string_view& key);
+		static uint64_t hashOf(const ModStats& s);
+
+		// Pin edits, for readers that care about them (the table, pinned alerts).
+		std::atomic<uint64_t> pinVersion{ 1 };
+		inline void touchPins() { pinVersion.fetch_add(1, std::memory_order_release); }
+
+		void apply(const Match& m);
+		void dropPending();
+		bool evictOldest();
+		void enforceBudget();
+		void requeue();
+
+		// Newest first, up to limit records with levelMask & mask, normalized.
+		std::vector<ModStats::Record> collect(const std::string& modKey, const size_t& limit, const uint8_t& mask) const;
+
+	public:
+
+		explicit Aggregator(const size_t& maxMsgs = 500) : cap(maxMsgs) {
+			logger::info("Aggregator initialized with capacity {}", cap.load(std::memory_order_relaxed));
+			mods.reserve(128);
+		}
+
+		// This version is faster than the standard stem. The watcher interns the result
+		// per file, so it only runs on discovery.
+		inline static std::string keyOfFast(const std::string_view& path) {
 			const auto sep = path.find_last_of("/\\");
 			auto fname = (sep == std::string_view::npos) ? path : path.substr(sep + 1);
 			const auto dot = fname.find_last_of('.');
@@ -33,60 +143,98 @@ namespace Logwatch {
 			return std::string(stem);
 		}
 
-	public:
+		// Queues m; it shows up once the next commit() ran. Commits by itself when the
+		// queue is full.
+		void add(Match&& m);
 
-		explicit Aggregator(const size_t& maxMsgs = 500) : cap(maxMsgs) {
-			logger::info("Aggregator initialized with capacity {}", cap.load(std::memory_order_relaxed));
-			mods.reserve(128);
+		// Applies everything queued so far under one exclusive lock.
+		void commit();
+
+		struct LockStats {
+			uint64_t commits = 0;
+			uint64_t matches = 0;
+			uint64_t holdNs = 0;
+			uint64_t maxHoldNs = 0;
+		};
+
+		inline void setBatchLimit(const size_t& n) {
+			batchLimit.store(std::clamp<size_t>(n, 1, kInboxSize), std::memory_order_relaxed);
 		}
 
-		void add(const Match& m);
+		inline LockStats lockStats() const {
+			return { commits.load(std::memory_order_relaxed), committed.load(std::memory_order_relaxed),
+					 holdNs.load(std::memory_order_relaxed), maxHoldNs.load(std::memory_order_relaxed) };
+		}
 
 		std::vector<ModStats::Record> recent(const std::string& modKey, const size_t& limit = SIZE_MAX) const;
 		std::vector<ModStats::Record> recentLevel(const std::string& modKey, const size_t& limit, const uint8_t& levelMask) const;
 
 		// Deep Scan ON
 		inline void backupAndClear() {
+			dropPending();
 			std::unique_lock lock(_mutex_);
 			backup = std::move(mods);
 			mods.clear();
+			historyBackup = std::move(history);
+			history.clear();
+			rollingBackup = rolling.exchange(FNV_OFFSET, std::memory_order_relaxed);
+			requeue();
+			touchAll();
 		}
 
 		// Deep Scan OFF
-		inline void restoreAndClear() {
-			std::unique_lock lock(_mutex_);
-			if (!backup.empty()) {
-				mods = std::move(backup);
-				backup.clear();
-				const auto c = cap.load(std::memory_order_relaxed);
-				for (auto& [_, s] : mods) while (s.last.size() > c) s.last.pop_front();
-			}
-			else {
-				mods.clear();
-			}
-		}
+		void restoreAndClear();
 
 		inline void invalidateBackup() {
 			std::unique_lock lock(_mutex_);
 			backup.clear();
+			historyBackup.clear();
+			rollingBackup = FNV_OFFSET;
 		}
 
 		inline void clear() {
+			dropPending();
 			std::unique_lock lock(_mutex_);
 			mods.clear();
+			history.clear();
+			rolling.store(FNV_OFFSET, std::memory_order_relaxed);
+			requeue();
+			touchAll();
 		}
 
 		inline void clearPins() {
 			std::unique_lock lock(_mutex_);
 			pinned.clear();
+			touchPins();
+		}
+
+		// Immutable counts of every mod. O(1) unless something changed since the last one
+		// was built, then whoever asks first builds the next, O(mods) and no strings.
+		inline std::shared_ptr<const CountsTable> counts() const {
+			const auto p = current();
+			return std::shared_ptr<const CountsTable>(p, &p->table);
 		}
 
-		inline Snapshot snapshot() const {
+		// Rows that changed after version since (0 = everything). Nothing changed is one
+		// atomic load and an empty result.
+		Changes changedSince(const uint64_t& since) const;
+
+		// Order independent hash of every mod's name and counts, what the watch file is
+		// written from. One atomic load; equal means the file wouldn't change.
+		inline uint64_t watchHash() const {
+			return rolling.load(std::memory_order_relaxed);
+		}
+
+		inline uint64_t pinsVersion() const {
+			return pinVersion.load(std::memory_order_acquire);
+		}
+
+		// Counts of one mod, if we have any.
+		inline std::optional<ModCounts> summary(const std::string& modKey) const {
 			std::shared_lock lock(_mutex_);
-			Snapshot out;
-			out.reserve(mods.size()); // avoids rehashing
-			for (const auto& m : mods) out.emplace(m.first, m.second);
-			return out;
+			const auto it = mods.find(modKey);
+			if (it == mods.end()) return std::nullopt;
+			return countsOf(it->first, it->second);
 		}
 
 		inline std::unordered_set<std::string> snapshotPins() const {
@@ -99,28 +247,47 @@ namespace Logwatch {
 
 		inline void reset(const std::string& modKey) {
 			std::unique_lock lock(_mutex_);
-			mods.erase(modKey);
-		}
-
-		inline void setCapacity(const size_t& n) {
-			std::unique_lock lock(_mutex_);
-			cap.store(n, std::memory_order_relaxed);
-			for (auto& [_, s] : mods) {
-				while (s.last.size() > n) s.last.pop_front();
+			const auto it = mods.find(modKey);
+			if (it != mods.end()) {
+				rolling.fetch_sub(it->second.hash, std::memory_order_relaxed);
+				mods.erase(it);
 			}
-			logger::info("Aggregator capacity set to {}", n);
+			history.erase(modKey);
+			requeue();
+			touchAll();
 		}
 
+		void setCapacity(const size_t& n);
+
 		// TODO: do we need to nudge threads here?
 		inline size_t capacity() const {
 			return cap.load(std::memory_order_relaxed);
 		}
 
+		inline void setBudget(const size_t& bytes) {
+			std::unique_lock lock(_mutex_);
+			budget.store(bytes, std::memory_order_relaxed);
+			enforceBudget();
+			touchAll();
+			logger::info("Aggregator history budget set to {} MB", MB(bytes));
+		}
+
+		inline size_t budgetBytes() const {
+			return budget.load(std::memory_order_relaxed);
+		}
+
+		// Record text held right now, the same count the budget is enforced on.
+		inline size_t historyBytes() const {
+			std::shared_lock lock(_mutex_);
+			return textBytes;
+		}
+
 
 		inline void replacePins(const std::unordered_set<std::string>& pins) {
 			std::unique_lock lock(_mutex_);
 			pinned.clear();
 			pinned.insert(pins.begin(), pins.end());
+			touchPins();
 		}
 
 		inline bool isPinned(const std::string& mod) const {
@@ -132,6 +299,7 @@ namespace Logwatch {
 			std::unique_lock lock(_mutex_);
 			if (pin) pinned.insert(mod); 
 			else pinned.erase(mod);
+			touchPins();
 		}
 
 
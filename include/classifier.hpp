@@ -0,0 +1,158 @@
+#pragma once
+
+#include <regex>
+#include <bitset>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stop_token>
+#include <string_view>
+#include <unordered_map>
+
+#include "config.hpp"
+#include "prefilter.hpp"
+
+namespace Logwatch {
+
+    // Parsed level pattern. Covers the ECMAScript we actually write patterns in: literals,
+    // classes, ., groups, |, quantifiers, ^, $, \b and \B. Anything else (backreferences,
+    // lookahead, \u...) makes parse fail and the pattern stays on std::regex.
+    namespace Rx {
+
+        using CharSet = std::bitset<256>;
+
+        enum class Op : uint8_t { Empty, Set, Cat, Alt, Repeat, LineStart, LineEnd, WordBoundary, NotWordBoundary };
+
+        struct Node {
+            Op                op = Op::Empty;
+            CharSet           set;          // Set
+            std::vector<Node> kids;         // Cat, Alt; Repeat has exactly one
+            int               min = 0;      // Repeat
+            int               max = -1;     // Repeat, -1 is unbounded
+        };
+
+        bool parse(const std::string_view& src, const bool& icase, Node& out);
+
+        // Keywords (lowercase, no whitespace) such that every match of n contains one of
+        // them. False when there's no such set, e.g. for ".+".
+        bool keywords(const Node& n, std::vector<std::string>& out);
+
+        // True for ".+" and friends, which match any non-empty line.
+        bool matchesAnyLine(const Node& n);
+
+        inline bool isWord(const unsigned char& c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        }
+
+    }
+
+    // Classifies a line against all level patterns in one left-to-right pass. The patterns
+    // are compiled into one NFA and a DFA is built from it lazily, a state at a time, as
+    // lines need it. Priority is still first-match-wins in Config::patterns order.
+    // Only the watcher thread classifies.
+    class Classifier {
+
+    private:
+
+        struct NState {
+            enum class Kind : uint8_t { Set, Split, Assert, Accept };
+            Kind  kind = Kind::Split;
+            Rx::Op assert = Rx::Op::Empty;
+            int   set = -1;      // index into sets
+            int   out = -1;
+            int   out1 = -1;
+            int   pattern = -1;  // Accept
+        };
+
+        struct DState {
+            std::vector<int> kernel;    // NFA states reached by the last byte (before closure)
+            bool             atStart = false;
+            bool             prevWord = false;
+            bool             endKnown = false;
+            uint64_t         endAccept = 0;
+        };
+
+        static constexpr size_t kMaxPatterns = 64;      // one bit each in the accept masks
+        static constexpr size_t kMaxNfaStates = 1 << 15;
+        static constexpr size_t kMaxDfaStates = 2048;   // cache is flushed when it gets this big
+
+        // NFA
+        std::vector<NState>      nfa;
+        std::vector<Rx::CharSet> sets;
+        std::vector<int>         starts;
+
+        // Pattern bookkeeping, index = position in Config::patterns.
+        std::vector<int>        bitOf;        // accept bit, or -1 if on std::regex
+        std::vector<std::regex> fallback;     // only filled for those
+        uint64_t                stopMask = 0; // seeing this one means nothing can beat it
+
+        // Keyword prefilter: lines without keywords of any pattern that could beat the
+        // first catch-all pattern go straight to it, without running the DFA.
+        Prefilter        prefilter;
+        uint64_t         keywordless = 0;  // patterns (by index) with no keywords, always candidates
+        int              catchAll = -1;    // first pattern that matches any non-empty line
+        uint64_t         linesSeen = 0;
+        uint64_t         linesPassed = 0;  // ones the prefilter sent on to the full match
+
+        // Byte equivalence classes: bytes no pattern can tell apart share a column.
+        uint8_t              byteClass[256]{};
+        std::vector<uint8_t> classRep;
+        size_t               numClasses = 1;
+
+        // Lazy DFA
+        std::vector<DState>                  dstates;
+        std::vector<int32_t>                 trans;  // dstates * numClasses, -1 = not built yet
+        std::vector<uint64_t>                accept; // patterns matched just before consuming that class
+        std::unordered_map<std::string, int> index;
+        int                                  startState = -1;
+        uint64_t                             flushes = 0;
+
+        // Scratch
+        std::vector<int>      stack;
+        std::vector<int>      consumers;
+        std::vector<uint32_t> mark;
+        uint32_t              epoch = 0;
+
+        int  emit(const Rx::Node& n, int next);
+        int  addState(const NState& s);
+        void buildClasses();
+
+        void closure(const std::vector<int>& kernel, const bool& atStart, const bool& prevWord,
+                     const bool& atEnd, const bool& nextWord, uint64_t& acc);
+        int  intern(std::vector<int>&& kernel, const bool& atStart, const bool& prevWord);
+        int  step(int s, const uint8_t& cls, uint64_t& acc);
+        uint64_t acceptAtEnd(const int& s);
+        void resetCache();
+
+    public:
+
+        // Compiles what it can; the rest is kept as std::regex.
+        void build(const std::vector<LevelPattern>& patterns);
+
+        // Index into the patterns given to build of the first one found in line, or -1.
+        int classify(const std::string_view& line);
+
+        inline size_t patternCount() const noexcept { return bitOf.size(); }
+        inline size_t dfaStates() const noexcept { return dstates.size(); }
+        inline uint64_t cacheFlushes() const noexcept { return flushes; }
+
+        // Lines classified / lines that needed the full match.
+        inline uint64_t prefilterLines() const noexcept { return linesSeen; }
+        inline uint64_t prefilterPassed() const noexcept { return linesPassed; }
+
+        // Builds its own classifier from patterns and runs lines random lines through it and
+        // through the patterns' std::regex (first match wins), prefilter included. Returns how
+        // many disagree and logs the first few. Lines are made of level words, brackets,
+        // punctuation, random bytes and whatever extra fragments the caller adds. Stops
+        // early (counting what it got through) once stop is requested.
+        static size_t crossCheck(const std::vector<LevelPattern>& patterns, const size_t& lines,
+                                 const uint32_t& seed = 1, const std::vector<std::string>& extra = {},
+                                 const std::stop_token& stop = {});
+
+        // The default patterns on 600k lines through the generic engine (which never sees
+        // them otherwise, DefaultLevels::classify takes over). Takes seconds; debug builds
+        // have a button for it in the settings, nothing runs it on its own.
+        static bool selfTest(const std::stop_token& stop = {});
+    };
+
+}
@@ -5,12 +5,29 @@
 #include <string>
 #include <chrono>
 #include "settings_def.hpp"
+#include "levels.hpp"
 #include "logger.hpp"
 
 namespace Logwatch {
 
 #define SIZE2CONFIG(S, D)  size_t S = D;
 
+    // A level pattern. The source is kept so the classifier can compile it itself;
+    // rx is what it falls back to for syntax it doesn't handle.
+    struct LevelPattern {
+        std::string name;
+        std::string source;
+        bool        icase = false;
+        std::regex  rx;
+
+        LevelPattern(std::string n, std::string src, const bool& ic)
+            : name(std::move(n))
+            , source(std::move(src))
+            , icase(ic)
+            , rx(source, ic ? std::regex::ECMAScript | std::regex::icase : std::regex::ECMAScript)
+        {}
+    };
+
     struct Config {
         
         FOREACH_BOOL_SETTING(BOOL2DEF);
@@ -19,7 +36,7 @@ namespace Logwatch {
 
         std::regex includeFileRegex;
         std::regex excludeFileRegex;
-        std::vector<std::pair<std::string, std::regex>> patterns;
+        std::vector<LevelPattern> patterns;
 
         // Manual conversion (must be ouside code generation above)
         std::chrono::milliseconds pollInterval{ std::chrono::milliseconds{pollIntervalMs} };
@@ -28,25 +45,11 @@ namespace Logwatch {
             : includeFileRegex(R"((?:^|[\\/]).+\.(?:log)$)", std::regex::icase)
             , excludeFileRegex(R"((^|[\\/])crash-\d{4}-\d{2}-\d{2}-\d{2}-\d{2}-\d{2}\.log$)", std::regex::icase)
             , patterns{
-                {"error", 
-                    std::regex(
-                      R"((\[\s*(error|e|critical|crit)\s*\])"
-                      R"(|\(\s*(error|e|critical|crit)\s*\))"
-                      R"(|(^|\s)(ERROR|ERR|CRITICAL|CRIT)\b)"
-                      R"(|(^|\s)error:)"
-                      R"(|(^|\s)critical:))",
-                    std::regex::icase)
-                },
-                {"warning", 
-                    std::regex(
-                      R"((\[\s*warn(?:ing)?\s*\])"
-                      R"(|\(\s*warn(?:ing)?\s*\))"
-                      R"(|(^|\s)WARN(?:ING)?\b)"
-                      R"(|(^|\s)warning:))",
-                    std::regex::icase)
-                },
-                {"fail",    std::regex(R"((\bfail(?:ed|ure)?\b|\[\s*fail(?:ed|ure)?\s*\]))", std::regex::icase)},
-                {"other",   std::regex(R"(.+)", std::regex::ECMAScript)}
+                // sources live in levels.hpp, next to the hand-written matcher for them
+                {"error",   std::string(DefaultLevels::errorSource),   true},
+                {"warning", std::string(DefaultLevels::warningSource), true},
+                {"fail",    std::string(DefaultLevels::failSource),    true},
+                {"other",   std::string(DefaultLevels::otherSource),   false}
             }
         {
             pollInterval = std::chrono::milliseconds{ pollIntervalMs };
@@ -55,7 +58,19 @@ namespace Logwatch {
             includeFileRegex = std::regex(R"(.+)", std::regex::ECMAScript);
             excludeFileRegex = std::regex(R"(^$)", std::regex::ECMAScript);
             patterns.clear();
-            patterns.emplace_back("other", std::regex(R"(.+)", std::regex::ECMAScript));
+            patterns.emplace_back("other", R"(.+)", false);
+        }
+
+        // Still the built-in patterns, so DefaultLevels::classify can stand in for them.
+        bool hasDefaultPatterns() const {
+            const auto same = [this](const size_t& i, const char* name, const std::string_view& src, const bool& icase) {
+                return patterns[i].name == name && patterns[i].source == src && patterns[i].icase == icase;
+            };
+            return patterns.size() == 4
+                && same(0, "error", DefaultLevels::errorSource, true)
+                && same(1, "warning", DefaultLevels::warningSource, true)
+                && same(2, "fail", DefaultLevels::failSource, true)
+                && same(3, "other", DefaultLevels::otherSource, false);
         }
 
         void loadFromSettings(const LogWatcherSettings& st) {
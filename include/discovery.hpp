@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <stop_token>
+#include <unordered_map>
+
+namespace Logwatch {
+
+    namespace fs = std::filesystem;
+
+    // A log file found under one of the roots.
+    struct DiscoveredFile {
+        fs::path    path;
+        std::string canon; // weakly canonical UTF-8 path, i.e. the key into LogWatcher::files
+    };
+
+    // Directory tree cache for discovery. A directory is only enumerated again when its
+    // mtime moved (something was created, deleted or renamed in it). Otherwise we reuse
+    // its children, so the include/exclude regexes and weakly_canonical run once per file
+    // instead of once per file per poll.
+    class DirCache {
+
+    public:
+
+        using Filter = std::function<bool(const fs::path&)>;
+
+    private:
+
+        struct Entry {
+            fs::path    path;
+            std::string canon;
+            bool        included = false;
+        };
+
+        struct Dir {
+            fs::file_time_type    mtime{};
+            bool                  settled = false; // mtime old enough to be trusted
+            uint64_t              seen = 0;        // generation of the last pass that reached it
+            std::vector<Entry>    files;
+            std::vector<fs::path> subdirs;
+        };
+
+        std::unordered_map<fs::path::string_type, Dir> dirs;
+        uint64_t generation = 0;
+
+        Dir& refresh(const fs::path& dir, const Filter& include);
+
+    public:
+
+        inline void beginPass() noexcept { ++generation; }
+
+        // Appends every included file under root.
+        void collect(const fs::path& root, const Filter& include, std::vector<DiscoveredFile>& out, const std::stop_token& stop);
+
+        // Forgets directories that weren't reached since beginPass (deleted or moved away).
+        void sweep();
+
+        inline void clear() { dirs.clear(); }
+
+        inline size_t directoryCount() const noexcept { return dirs.size(); }
+    };
+
+}
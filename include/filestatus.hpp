@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+
+namespace Logwatch {
+
+    namespace fs = std::filesystem;
+
+    // Which file a handle or a stat is looking at, regardless of its name.
+    struct FileId {
+        uint64_t volume = 0;
+        uint64_t index = 0;
+
+        inline bool known() const noexcept { return volume || index; }
+        inline bool operator==(const FileId&) const = default;
+    };
+
+    // Everything a poll needs to know about a file, from a single native stat.
+    struct FileStatus {
+        bool               exists = false;
+        uint64_t           size = 0;
+        fs::file_time_type writeTime{};
+        FileId             id{};       // only where the stat hands it out for free (not on Windows)
+
+        // One GetFileAttributesExW / stat call. Counted, see FileStatusCache.
+        static FileStatus query(const fs::path& p);
+
+        // Total native stat calls made so far (all threads).
+        static uint64_t calls() noexcept { return counter.load(std::memory_order_relaxed); }
+
+    private:
+        static inline std::atomic<uint64_t> counter{ 0 };
+    };
+
+    // Per-poll memo of file status, shared by discovery, tail and commit, so each file
+    // costs one stat per poll. The map is kept between polls to reuse its buckets.
+    class FileStatusCache {
+
+    private:
+
+        std::unordered_map<std::string, FileStatus> cache;
+        uint64_t pollStart = 0;
+
+    public:
+
+        // Drops last poll's results and starts a new syscall tally.
+        inline void beginPoll() {
+            pollStart = FileStatus::calls();
+            cache.clear();
+        }
+
+        inline const FileStatus& get(const std::string& key, const fs::path& p) {
+            auto [it, fresh] = cache.try_emplace(key);
+            if (fresh) it->second = FileStatus::query(p);
+            return it->second;
+        }
+
+        inline void invalidate(const std::string& key) { cache.erase(key); }
+
+        // Native stat calls made since beginPoll().
+        inline uint64_t pollSyscalls() const noexcept { return FileStatus::calls() - pollStart; }
+    };
+
+}
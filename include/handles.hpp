@@ -0,0 +1,149 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+
+#include "filestatus.hpp"
+
+namespace Logwatch {
+
+    namespace fs = std::filesystem;
+
+    // Read-only view of part of a file. Unmapped on destruction; keep it short-lived,
+    // Windows refuses to truncate a file while any view of it exists.
+    class MappedView {
+
+    private:
+
+        void*       base = nullptr;
+        size_t      baseLen = 0;
+        const char* ptr = nullptr;
+        size_t      len = 0;
+
+        void unmap() noexcept;
+
+        friend class ReadHandle;
+
+    public:
+
+        MappedView() = default;
+        ~MappedView() { unmap(); }
+
+        MappedView(MappedView&& o) noexcept { *this = std::move(o); }
+        MappedView& operator=(MappedView&& o) noexcept;
+
+        MappedView(const MappedView&) = delete;
+        MappedView& operator=(const MappedView&) = delete;
+
+        inline bool valid() const noexcept { return ptr != nullptr; }
+        inline const char* data() const noexcept { return ptr; }
+        inline size_t size() const noexcept { return len; }
+    };
+
+    // Page aligned read buffer that only ever grows, so tailing doesn't allocate per chunk.
+    class ChunkBuffer {
+
+    private:
+
+        struct AlignedFree { void operator()(char* p) const noexcept; };
+
+        std::unique_ptr<char[], AlignedFree> mem;
+        size_t cap = 0;
+
+    public:
+
+        static constexpr size_t kAlignment = 4096;
+
+        // At least n writable bytes; previous contents are not kept.
+        char* reserve(const size_t& n);
+
+        inline size_t capacity() const noexcept { return cap; }
+    };
+
+    // Read-only handle opened so that the game can still write, rename and delete the log
+    // while we hold it (FILE_SHARE_DELETE on Windows; nothing to ask for on POSIX).
+    class ReadHandle {
+
+    private:
+
+#if defined(_WIN32)
+        void* h = nullptr;
+        std::wstring openedAs; // the handle's own view of its name at open time
+#else
+        int fd = -1;
+#endif
+        FileId fid;
+
+        void close() noexcept;
+
+    public:
+
+        ReadHandle() = default;
+        ~ReadHandle() { close(); }
+
+        ReadHandle(ReadHandle&& o) noexcept { *this = std::move(o); }
+        ReadHandle& operator=(ReadHandle&& o) noexcept;
+
+        ReadHandle(const ReadHandle&) = delete;
+        ReadHandle& operator=(const ReadHandle&) = delete;
+
+        static ReadHandle open(const fs::path& p);
+
+        bool valid() const noexcept;
+
+        inline const FileId& id() const noexcept { return fid; }
+
+        // The file was renamed away from its path or deleted while we held it (log rotation).
+        bool detached() const;
+
+        // Positional read, doesn't care where the last one ended. Returns bytes read.
+        size_t readAt(const uint64_t& offset, char* dst, const size_t& n) const;
+
+        // Maps [offset, offset + n); invalid view if the range isn't in the file or mapping failed.
+        MappedView map(const uint64_t& offset, const size_t& n) const;
+    };
+
+    // Keeps the last few tailed files open so chatty logs don't pay an open/close per poll.
+    // Only the watcher thread touches it.
+    class HandlePool {
+
+    private:
+
+        struct Slot {
+            std::string key;
+            ReadHandle  handle;
+        };
+
+        // Front is the most recently used.
+        std::list<Slot> lru;
+        std::unordered_map<std::string, std::list<Slot>::iterator> index;
+        size_t cap;
+
+        uint64_t opens = 0;
+        uint64_t reuses = 0;
+
+    public:
+
+        static constexpr size_t kDefaultCapacity = 32;
+
+        explicit HandlePool(const size_t& capacity = kDefaultCapacity) : cap(capacity ? capacity : 1) {}
+
+        // Returns an open handle for key, reopening it if the file behind the path changed
+        // (expected is the identity the caller just saw at the path, if it knows one).
+        ReadHandle* acquire(const std::string& key, const fs::path& p, const FileId& expected = {});
+
+        // Drop the handle, e.g. the file vanished or got truncated.
+        void release(const std::string& key);
+
+        inline void clear() { index.clear(); lru.clear(); }
+
+        inline size_t size() const noexcept { return lru.size(); }
+        inline uint64_t openCount() const noexcept { return opens; }
+        inline uint64_t reuseCount() const noexcept { return reuses; }
+    };
+
+}
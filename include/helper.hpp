@@ -18,11 +18,13 @@ namespace Live {
         return ImGui::GetWindowContentRegionMax();
     }
 
-    inline const ImVec4& LevelColor(const std::string& lvl) {
-        if (lvl == "error") return Colors::Error;
-        if (lvl == "warning") return Colors::Warning;
-        if (lvl == "fail") return Colors::Fail;
-        return Colors::Other;
+    inline const ImVec4& LevelColor(const Logwatch::Level& lvl) {
+        switch (lvl) {
+        case Logwatch::Level::kError:   return Colors::Error;
+        case Logwatch::Level::kWarning: return Colors::Warning;
+        case Logwatch::Level::kFail:    return Colors::Fail;
+        default:                        return Colors::Other;
+        }
     }
 
     inline ImVec4 LevelColor(const Logwatch::Level& lvl, const float& alpha) {
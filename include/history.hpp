@@ -0,0 +1,107 @@
+#pragma once
+
+#include <deque>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <string_view>
+
+#include "ring.hpp"
+#include "statistics.hpp"
+
+namespace Logwatch {
+
+    // Text of one mod's records, packed into slabs front to back. Records die oldest first,
+    // so slabs do too: once the oldest live record sits in slab k, everything before k goes.
+    // Slabs start small and double up to kMaxSlab, so a mod with three lines doesn't sit
+    // on 64 KB.
+    class TextArena {
+
+    private:
+
+        static constexpr uint32_t kMinSlab = 1024;
+        static constexpr uint32_t kMaxSlab = 64 * 1024;
+
+        struct Slab {
+            std::unique_ptr<char[]> data;
+            uint32_t size = 0;
+            uint32_t used = 0;
+        };
+
+        std::deque<Slab> slabs;
+        uint32_t firstSlab = 0;  // number of slabs.front(); numbers keep counting up
+        uint32_t nextSize = kMinSlab;
+        size_t   allocated = 0;
+
+    public:
+
+        struct Span {
+            uint32_t slab = 0;
+            uint32_t offset = 0;
+            uint32_t length = 0;
+        };
+
+        Span append(const std::string_view& s);
+
+        // Frees every slab numbered below slab.
+        void releaseBefore(const uint32_t& slab);
+
+        inline void clear() {
+            slabs.clear();
+            firstSlab = 0;
+            nextSize = kMinSlab;
+            allocated = 0;
+        }
+
+        inline char* data(const Span& sp) { return slabs[sp.slab - firstSlab].data.get() + sp.offset; }
+
+        inline std::string_view view(const Span& sp) const {
+            return { slabs[sp.slab - firstSlab].data.get() + sp.offset, sp.length };
+        }
+
+        inline size_t bytes() const noexcept { return allocated; }
+    };
+
+    // Recent records of one mod: entries in a ring (count cap), text in an arena (bytes,
+    // budgeted across all mods by the Aggregator). Text is stored raw and normalized in
+    // place the first time it's shown; normalizing never makes a line longer.
+    struct ModHistory {
+
+        struct Entry {
+            uint64_t seq = 0;       // Aggregator-wide arrival order, for evicting across mods
+            uint64_t lineNo = 0;
+            std::chrono::system_clock::time_point when;
+            TextArena::Span text;
+            uint32_t fileId = 0;
+            Level level = Level::kOther;
+            bool normalized = false;
+        };
+
+        RingBuffer<Entry> entries;
+        TextArena         text;
+        bool              queued = false;  // has its entry in the Aggregator's eviction heap
+        uint64_t          version = 0;     // Aggregator version it last lost records to the budget
+
+        // Drops the oldest entry and whatever text only it was holding on to.
+        inline void popOldest() {
+            entries.popOldest();
+            if (entries.empty()) text.clear();
+            else text.releaseBefore(entries.oldest().text.slab);
+        }
+
+        inline void trim(const size_t& n) {
+            while (entries.size() > n) popOldest();
+            entries.setCapacity(n);
+        }
+
+        inline void clear() {
+            entries.clear();
+            text.clear();
+        }
+
+        // Text ready for display, normalized (once) if it wasn't yet.
+        std::string_view display(Entry& e);
+    };
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <stop_token>
+
+#include "logger.hpp"
+
+namespace Logwatch {
+
+    // One job at a time on a thread we own, for the odd button that kicks off slow work.
+    // start() while a job is still going is ignored rather than queued, and the destructor
+    // asks the job to stop and waits for it, so nothing runs past the plugin.
+    class BackgroundJob {
+
+    private:
+
+        std::jthread worker;
+        std::atomic<bool> busy{ false };
+
+    public:
+
+        BackgroundJob() = default;
+        ~BackgroundJob() { stop(); }
+
+        BackgroundJob(const BackgroundJob&) = delete;
+        BackgroundJob& operator=(const BackgroundJob&) = delete;
+
+        inline bool running() const noexcept { return busy.load(std::memory_order_acquire); }
+
+        // False if the last one hasn't finished. job gets the stop token and should
+        // check it now and then.
+        template <class F>
+        bool start(F&& job) {
+            bool idle = false;
+            if (!busy.compare_exchange_strong(idle, true, std::memory_order_acq_rel)) return false;
+
+            if (worker.joinable()) worker.join();  // done already, just not reaped
+            worker = std::jthread([this, job = std::forward<F>(job)](const std::stop_token& st) mutable {
+                try {
+                    job(st);
+                }
+                catch (const std::exception& e) {
+                    logger::error("Background job failed: {}", e.what());
+                }
+                catch (...) {
+                    logger::error("Background job failed for unknown reasons");
+                }
+                busy.store(false, std::memory_order_release);
+            });
+            return true;
+        }
+
+        inline void stop() {
+            if (!worker.joinable()) return;
+            worker.request_stop();
+            worker.join();
+        }
+    };
+
+}
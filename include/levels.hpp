@@ -0,0 +1,151 @@
+#pragma once
+
+#include <string_view>
+#include <initializer_list>
+
+namespace Logwatch::DefaultLevels {
+
+    /* The built-in level patterns. Config compiles these for the generic engine, and
+       classify() below is the same grammar written out by hand, so as long as nobody
+       overrides the patterns we don't need an engine at all. Change one, change both;
+       the static_asserts at the bottom are there to catch it. */
+
+    inline constexpr std::string_view errorSource =
+        R"((\[\s*(error|e|critical|crit)\s*\])"
+        R"(|\(\s*(error|e|critical|crit)\s*\))"
+        R"(|(^|\s)(ERROR|ERR|CRITICAL|CRIT)\b)"
+        R"(|(^|\s)error:)"
+        R"(|(^|\s)critical:))";
+
+    inline constexpr std::string_view warningSource =
+        R"((\[\s*warn(?:ing)?\s*\])"
+        R"(|\(\s*warn(?:ing)?\s*\))"
+        R"(|(^|\s)WARN(?:ING)?\b)"
+        R"(|(^|\s)warning:))";
+
+    inline constexpr std::string_view failSource =
+        R"((\bfail(?:ed|ure)?\b|\[\s*fail(?:ed|ure)?\s*\]))";
+
+    inline constexpr std::string_view otherSource = R"(.+)";
+
+    // Same order as in Config::patterns.
+    enum Level : int { None = -1, Error = 0, Warning = 1, Fail = 2, Other = 3 };
+
+    namespace detail {
+
+        constexpr char lower(const char& c) { return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c; }
+
+        constexpr bool isSpace(const char& c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+        }
+
+        constexpr bool isWord(const char& c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        }
+
+        constexpr bool isLetter(const char& c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+        constexpr bool equalsNoCase(const std::string_view& a, const std::string_view& b) {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (lower(a[i]) != lower(b[i])) return false;
+            }
+            return true;
+        }
+
+        constexpr bool isAnyOf(const std::string_view& w, const std::initializer_list<std::string_view>& set) {
+            for (const auto& s : set) {
+                if (equalsNoCase(w, s)) return true;
+            }
+            return false;
+        }
+
+        constexpr size_t skipSpaces(const std::string_view& s, size_t i) {
+            while (i < s.size() && isSpace(s[i])) ++i;
+            return i;
+        }
+
+        // "[ error ]", "(warn)", "[failed]" starting at the bracket at i.
+        constexpr Level bracketed(const std::string_view& s, const size_t& i) {
+            const char close = s[i] == '[' ? ']' : ')';
+
+            const size_t from = skipSpaces(s, i + 1);
+            size_t to = from;
+            while (to < s.size() && isLetter(s[to])) ++to;
+
+            const size_t end = skipSpaces(s, to);
+            if (end >= s.size() || s[end] != close) return None;
+
+            const auto w = s.substr(from, to - from);
+            if (isAnyOf(w, { "error", "e", "critical", "crit" })) return Error;
+            if (isAnyOf(w, { "warn", "warning" }))                  return Warning;
+            if (close == ']' && isAnyOf(w, { "fail", "failed", "failure" })) return Fail;
+            return None;
+        }
+
+        // The word s[i, to): "ERROR" after whitespace (or the start), "fail" after anything.
+        // A word has to end where the keyword does, that's the \b.
+        constexpr Level word(const std::string_view& s, const size_t& i, const size_t& to) {
+            const auto w = s.substr(i, to - i);
+
+            // every keyword is 3 to 8 letters starting with one of these
+            if (w.size() < 3 || w.size() > 8) return None;
+            const char first = lower(w[0]);
+            if (first != 'e' && first != 'c' && first != 'w' && first != 'f') return None;
+
+            if (i == 0 || isSpace(s[i - 1])) {
+                if (isAnyOf(w, { "error", "err", "critical", "crit" })) return Error;
+                if (isAnyOf(w, { "warn", "warning" }))                  return Warning;
+            }
+            if (isAnyOf(w, { "fail", "failed", "failure" })) return Fail;
+            return None;
+        }
+
+    }
+
+    // First level (in Config order) whose default pattern matches somewhere in line.
+    constexpr Level classify(const std::string_view& line) {
+        if (line.empty()) return None;
+
+        Level best = Other;
+        for (size_t i = 0; i < line.size(); ++i) {
+            Level l = None;
+            const char c = line[i];
+
+            if (c == '[' || c == '(') {
+                l = detail::bracketed(line, i);
+            }
+            else if (detail::isWord(c)) {
+                // we only ever land here at the start of a word
+                size_t to = i + 1;
+                while (to < line.size() && detail::isWord(line[to])) ++to;
+                l = detail::word(line, i, to);
+                i = to - 1;
+            }
+
+            if (l != None && l < best) {
+                best = l;
+                if (best == Error) break;
+            }
+        }
+        return best;
+    }
+
+    static_assert(classify("") == None);
+    static_assert(classify("all good") == Other);
+    static_assert(classify("[12:00:01] [ ERROR ] something") == Error);
+    static_assert(classify("(e) bad thing") == Error);
+    static_assert(classify("Critical: out of memory") == Error);
+    static_assert(classify("terror: no") == Other);
+    static_assert(classify("errors were found") == Other);
+    static_assert(classify("[warning] a [error]") == Error);
+    static_assert(classify("x WARN y") == Warning);
+    static_assert(classify("x,WARN y") == Other);
+    static_assert(classify("(Warning)") == Warning);
+    static_assert(classify("load failed.") == Fail);
+    static_assert(classify("(failed)") == Fail);
+    static_assert(classify("[ Failure ]") == Fail);
+    static_assert(classify("failing test") == Other);
+    static_assert(classify("[err]") == Other);
+
+}
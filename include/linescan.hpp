@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <string_view>
+
+namespace Logwatch::LineScan {
+
+    // Appends the position of every '\r' and '\n' in chunk to out (out isn't cleared,
+    // so the caller can reuse its capacity). One pass over the chunk, vectorized with
+    // AVX2 or SSE2 when the CPU has them.
+    void findBreaks(const std::string_view& chunk, std::vector<size_t>& out);
+
+    // Which implementation findBreaks picked at startup: "avx2", "sse2" or "scalar".
+    const char* implementation();
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace Logwatch {
+
+    // Bounded lock-free queue, any number of producers, one consumer (Vyukov's array
+    // queue). Every cell carries a sequence number that says whose turn it is: producers
+    // claim a slot with one CAS on tail, the consumer owns head outright. push() fails
+    // instead of blocking when it's full, the caller decides what to do about that.
+    template <class T>
+    class MpscQueue {
+
+    private:
+
+        struct Cell {
+            std::atomic<size_t> seq;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+
+        alignas(64) std::atomic<size_t> tail{ 0 };  // producers
+        alignas(64) size_t head = 0;                // consumer only
+
+    public:
+
+        // Capacity is rounded up to a power of two.
+        explicit MpscQueue(const size_t& capacity) {
+            size_t n = 2;
+            while (n < capacity) n <<= 1;
+            cells = std::make_unique<Cell[]>(n);
+            mask = n - 1;
+            for (size_t i = 0; i < n; ++i) cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        bool push(T&& v) {
+            size_t pos = tail.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& c = cells[pos & mask];
+                const auto seq = c.seq.load(std::memory_order_acquire);
+                const auto dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (dif == 0) {
+                    if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        c.value = std::move(v);
+                        c.seq.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (dif < 0) {
+                    return false; // full: the consumer hasn't freed this cell yet
+                }
+                else {
+                    pos = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Consumer only.
+        bool pop(T& out) {
+            Cell& c = cells[head & mask];
+            const auto seq = c.seq.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(head + 1) < 0) return false;
+            out = std::move(c.value);
+            c.seq.store(head + mask + 1, std::memory_order_release);
+            ++head;
+            return true;
+        }
+
+        inline size_t capacity() const noexcept { return mask + 1; }
+    };
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <stop_token>
+
+namespace Logwatch {
+
+    namespace fs = std::filesystem;
+
+    // Tells the watcher which files were written so it can sleep through the idle polls.
+    // Backed by ReadDirectoryChangesW on Windows and inotify on Linux; anything else
+    // reports unsupported and the watcher keeps its fixed-interval polling.
+    class ChangeNotifier {
+
+    private:
+
+        // OS handles, defined per platform in notifier.cpp.
+        struct Backend;
+        std::unique_ptr<Backend> backend;
+
+        // The OS wait lives on its own thread, the watcher only drains the results.
+        std::jthread worker;
+        std::atomic<bool> alive{ false };
+
+        mutable std::mutex _mutex_;
+
+        // Paths reported since the last drain (may contain duplicates).
+        std::vector<fs::path> pending;
+
+        // The OS dropped events (or we did), so pending can't be trusted anymore.
+        bool overflowed{ false };
+
+        // Called from the notifier thread after pending got new entries.
+        std::function<void()> wake;
+
+        void run(const std::stop_token& stop);
+
+        void push(fs::path&& p);
+
+        inline void markOverflow() {
+            std::lock_guard lock(_mutex_);
+            overflowed = true;
+        }
+
+    public:
+
+        ChangeNotifier();
+        ~ChangeNotifier();
+
+        ChangeNotifier(const ChangeNotifier&) = delete;
+        ChangeNotifier& operator=(const ChangeNotifier&) = delete;
+
+        static bool supported() noexcept;
+
+        // Starts watching the roots recursively; false means "keep polling".
+        bool start(const std::vector<fs::path>& roots, std::function<void()> onChange);
+
+        void stop();
+
+        // False once the backend thread died, so the watcher can fall back to polling.
+        inline bool running() const noexcept { return alive.load(std::memory_order_acquire); }
+
+        inline bool hasPending() const {
+            std::lock_guard lock(_mutex_);
+            return overflowed || !pending.empty();
+        }
+
+        // Moves out the changed paths (deduplicated).
+        // Returns false if events were lost, i.e. the caller needs a full scan.
+        bool drain(std::vector<fs::path>& out);
+    };
+
+}
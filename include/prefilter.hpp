@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+namespace Logwatch {
+
+    // Case-insensitive Aho-Corasick over the keywords of the level patterns. Whitespace is
+    // skipped on both sides (keywords are stored without it), so "[ error ]" still hits
+    // "[error]"; that only ever adds hits, so a line it rejects really can't match.
+    class Prefilter {
+
+    private:
+
+        // Bytes the keywords don't use all share column 0.
+        uint8_t               alpha[256]{};
+        size_t                width = 1;
+        std::vector<int32_t>  delta;   // states * width
+        std::vector<uint64_t> out;     // keyword bits ending at (or suffix-linked from) a state
+        uint64_t              all = 0;
+
+    public:
+
+        // keywords[b] are the keywords for bit b (at most 64). An empty list means bit b
+        // never shows up in scan results; the caller treats those as always candidates.
+        void build(const std::vector<std::vector<std::string>>& keywords);
+
+        // Bits whose keywords occur in line.
+        uint64_t scan(const std::string_view& line) const;
+
+        inline bool empty() const noexcept { return all == 0; }
+
+        inline static bool isSpace(const unsigned char& c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+        }
+
+        inline static unsigned char lower(const unsigned char& c) {
+            return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+        }
+    };
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+namespace Logwatch {
+
+    // Fixed-capacity ring. Slots are allocated as it fills up and recycled after that:
+    // push() hands back the oldest (or a popped) slot for the caller to overwrite, so
+    // whatever a T owns (string capacity, say) gets reused instead of freed and allocated
+    // again.
+    template <class T>
+    class RingBuffer {
+
+    private:
+
+        std::vector<T> buf;
+        size_t head = 0;   // oldest
+        size_t count = 0;
+        size_t cap = 0;
+
+        inline size_t slot(const size_t& i) const { return (head + i) % buf.size(); }
+
+        // Oldest first from index 0, head back to 0.
+        inline void linearize() {
+            if (head) std::rotate(buf.begin(), buf.begin() + head, buf.end());
+            head = 0;
+        }
+
+    public:
+
+        RingBuffer() = default;
+        explicit RingBuffer(const size_t& capacity) : cap(capacity) {}
+
+        // Slot for the newest element; the caller assigns every field. Evicts the oldest
+        // when full. Don't call it with capacity 0.
+        inline T& push() {
+            if (count < buf.size()) return buf[slot(count++)];
+            if (buf.size() < cap) {
+                linearize();
+                ++count;
+                return buf.emplace_back();
+            }
+            T& s = buf[head];
+            head = (head + 1) % buf.size();
+            return s;
+        }
+
+        // The slot stays allocated for the next push.
+        inline void popOldest() {
+            head = (head + 1) % buf.size();
+            --count;
+        }
+
+        // i = 0 is the newest.
+        inline const T& newest(const size_t& i) const { return buf[slot(count - 1 - i)]; }
+        inline T& newest(const size_t& i) { return buf[slot(count - 1 - i)]; }
+
+        inline const T& oldest() const { return buf[head]; }
+
+        inline size_t size() const noexcept { return count; }
+        inline size_t capacity() const noexcept { return cap; }
+        inline bool empty() const noexcept { return count == 0; }
+        inline bool full() const noexcept { return count == cap; }
+
+        // Keeps the newest min(size, n), in one move.
+        inline void setCapacity(const size_t& n) {
+            linearize();
+            buf.resize(count);
+            if (count > n) {
+                buf.erase(buf.begin(), buf.begin() + (count - n));
+                count = n;
+            }
+            if (buf.capacity() > n) buf.shrink_to_fit();
+            cap = n;
+        }
+
+        // Keeps the allocation for the next round.
+        inline void clear() noexcept {
+            head = 0;
+            count = 0;
+        }
+    };
+
+}
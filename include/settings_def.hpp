@@ -12,8 +12,11 @@ namespace Logwatch {
     S(pauseWatcher,             false) \
     S(deepScan,                 false) \
     S(saveWatch,                true) \
+    S(saveTimeline,             true) \
     S(watchPapyrus,             true) \
     S(autoBoostOnBacklog,       true) \
+    S(eventDriven,              true) \
+    S(mapChunks,                false) \
     S(persistPins,              true) \
     /* Notifications */               \
     S(notificationsEnabled,     true) \
@@ -23,7 +26,10 @@ namespace Logwatch {
 
 #define FOREACH_SIZE_SETTING(S) \
     S(cacheCap,					1000) \
+    S(historyBudgetMB,          64) \
+    S(commitBatch,              4096) \
     S(pollIntervalMs,			500) \
+    S(eventRescanSec,           5) \
     S(maxChunkKB,               2048) \
     S(maxLineKB,                64) \
     S(papyrusMaxChunkKB,        8192) \
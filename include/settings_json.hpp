@@ -19,6 +19,10 @@ namespace Logwatch {
 		LogWatcherSettings oldSettings{ };
 		size_t oldPinsHash{ 0 };
 
+		// Custom level patterns exactly as they were in the file, so saving keeps them.
+		// There's no UI for these; whoever wants them edits the json.
+		json patterns;
+
 		// Source: Fowler–Noll–Vo hash function (FNV-1a), 64-bit variant
 		// Implemented for one purpose, ignored already saved/loaded pinned mods.
 		inline size_t hashPins(const std::unordered_set<std::string>& pins) {
@@ -70,6 +74,11 @@ namespace Logwatch {
 			FOREACH_FLT_SETTING(SETTING2GETTER)
 		}
 
+		// [{ "name": "error", "regex": "...", "icase": true }, ...] in priority order. The
+		// names error, warning and fail pick the level, anything else counts as other.
+		// False (and the defaults stay) if any of them is malformed.
+		bool from_json_patterns(const json& j, std::vector<LevelPattern>& out);
+
 		void saveState();
 
 		void saveStateAsync();
@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <filesystem>
 
+#include "statistics.hpp"
+
 namespace Logwatch {
 
     namespace fs = std::filesystem;
@@ -13,10 +15,11 @@ namespace Logwatch {
     enum class LogType { Generic, Papyrus };
 
     struct Match {
-        std::string file;           // Full path of the log file
-        std::string line;           // The matched line
-        std::string keyword;        // Which keyword/regex matched
-        std::string level;          // error (inc. critical)/warning/fail/other
+        uint32_t fileId = 0;        // Display name of the log file, in symbols
+        uint32_t modId = 0;         // Mod key (display name without extension), in symbols
+        std::string line;           // The matched line, trimmed but not normalized yet
+        uint32_t keyword = 0;       // Name of the pattern that matched, in symbols
+        Level level = Level::kOther; // error (inc. critical)/warning/fail/other
         uint64_t lineNo;            // 1-based line number
         std::chrono::system_clock::time_point when; // timestamp 
     };
@@ -27,10 +30,17 @@ namespace Logwatch {
         uint64_t sizeLastSeen = 0;       // last known file size
         fs::file_time_type writeTime{};  // last write time
         Clock::time_point lastPoll{};
+
+        // Unterminated last line of the previous chunk, waiting for its newline.
+        std::string carry;
+        Clock::time_point carrySince{};
+        bool skipLine = false;           // rest of an over-long (or timed out) line is dropped up to its newline
     };
 
     struct FileInfo {
         fs::path path;
+        uint32_t fileId = 0;        // spacified file name, interned once on discovery
+        uint32_t modId = 0;         // and the mod key derived from it
         TailState state;
         LogType type = LogType::Generic;
     };
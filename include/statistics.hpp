@@ -1,14 +1,27 @@
 ﻿#pragma once
 
-#include <deque>
 #include <string>
+#include <vector>
+#include <memory>
 #include <chrono>
+#include <string_view>
+#include <cstdint>
 #include <unordered_map>
 
 namespace Logwatch {
 
     enum Level : uint8_t { kError = 1, kWarning = 2, kFail = 4, kOther = 8 };
 
+    // Only for logs and the like; the UI translates levels itself.
+    constexpr std::string_view LevelName(const Level& l) {
+        switch (l) {
+        case kError:   return "error";
+        case kWarning: return "warning";
+        case kFail:    return "fail";
+        default:       return "other";
+        }
+    }
+
     struct ModStats {
 
         // TODO: this should be in Counts.
@@ -17,18 +30,45 @@ namespace Logwatch {
         int fails = 0;
         int others = 0;
 
+        uint32_t modId = 0;    // key, interned
+        uint64_t version = 0;  // Aggregator version of the last change
+        uint64_t nameHash = 0; // FNV-1a of the key, so hashing the counts doesn't walk it again
+        uint64_t hash = 0;     // this mod's share of Aggregator::watchHash()
+
+        // What Aggregator::recent hands out; the stored form is ModHistory::Entry.
         struct Record {
-            std::string level;
-            std::string file;
-            std::string text;
-            uint64_t lineNo;
+            uint32_t fileId = 0;  // in symbols
+            std::string text;     // normalized
+            uint64_t lineNo = 0;
             std::chrono::system_clock::time_point when;
-            uint8_t levelMask = Level::kOther;
+            Level level = Level::kOther;  // one bit, so it can be tested against a mask
         };
-
-        std::deque<Record> last;  // ring buffer
     };
 
     using Snapshot = std::unordered_map<std::string, ModStats>;
 
+    // One row of Aggregator::counts(), all most readers need.
+    struct ModCounts {
+        uint32_t modId = 0;   // in symbols
+        int errors = 0;
+        int warnings = 0;
+        int fails = 0;
+        int others = 0;
+        size_t cached = 0;    // records held for the details window
+        uint64_t version = 0; // Aggregator version this row last changed at
+    };
+
+    // Contiguous and sorted by modId.
+    using CountsTable = std::vector<ModCounts>;
+
+    // What Aggregator::changedSince hands out.
+    struct Changes {
+        uint64_t version = 0;  // pass this as since next time
+        bool full = false;     // mods went away (or everything shifted) since; changed has every mod
+        CountsTable changed;   // rows that moved, sorted by modId
+        std::shared_ptr<const CountsTable> all;  // the whole table at version
+
+        inline bool any() const noexcept { return full || !changed.empty(); }
+    };
+
 }
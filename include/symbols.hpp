@@ -0,0 +1,65 @@
+#pragma once
+
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+namespace Logwatch {
+
+    // Interned strings: display file names, mod keys and pattern names. Append-only
+    // and process-wide; an id is handed out once per distinct string and never reused, so
+    // records keep a 4-byte id instead of their own copy of the same few strings.
+    //
+    // Reads don't lock. Strings live in fixed-size chunks that never move; a writer fills
+    // the slot (allocating its chunk if needed) and only then publishes the new count, so
+    // any id below count is safe to read from any thread.
+    class SymbolTable {
+
+    private:
+
+        static constexpr uint32_t kChunkBits = 10;
+        static constexpr uint32_t kChunkSize = 1u << kChunkBits;
+        static constexpr uint32_t kMaxChunks = 4096;  // 4M strings, we'll never get close
+
+        std::array<std::atomic<std::string*>, kMaxChunks> chunks{};
+        std::atomic<uint32_t> count{ 0 };
+
+        // Writers only.
+        std::unordered_map<std::string_view, uint32_t> index;
+        std::mutex _mutex_;
+
+        uint32_t append(const std::string_view& s);
+
+    public:
+
+        // Interned by the constructor, so id 0 (the default everywhere) is always valid.
+        static constexpr uint32_t kEmpty = 0;
+
+        SymbolTable();
+        ~SymbolTable();
+
+        SymbolTable(const SymbolTable&) = delete;
+        SymbolTable& operator=(const SymbolTable&) = delete;
+
+        // Takes the writer lock; meant for discovery/setup, not the per-line path.
+        uint32_t intern(const std::string_view& s);
+
+        // Unknown ids read as the empty string. The reference is good for the lifetime of
+        // the table.
+        inline const std::string& name(const uint32_t& id) const {
+            const auto n = count.load(std::memory_order_acquire);
+            const auto i = id < n ? id : uint32_t(kEmpty);
+            return chunks[i >> kChunkBits].load(std::memory_order_relaxed)[i & (kChunkSize - 1)];
+        }
+
+        inline size_t size() const noexcept { return count.load(std::memory_order_acquire); }
+    };
+
+    extern SymbolTable symbols;
+
+}
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include "ui.hpp"
 #include "color.hpp"
 #include "helper.hpp"
@@ -37,6 +38,7 @@ namespace Live {
     // TODO: not sure if we should keep this separate from statistics?
     // because we have the extra field 'recent'.
     struct TableRow {
+        uint32_t modId{};
         std::string mod;
         int errors{};
         int warnings{};
@@ -51,6 +53,28 @@ namespace Live {
         return s;
     }
 
+    // Rows and view kept across frames. Rows follow Aggregator::changedSince, the view is
+    // only redone when rows, pins or the filter/sort settings changed.
+    struct TableCache {
+        std::vector<TableRow>             rows;
+        std::unordered_map<uint32_t, int> index;  // modId -> rows
+        std::vector<int>                  view;
+        uint64_t version = 0;
+        uint64_t pinsVersion = 0;
+
+        // What the view was made with.
+        std::string filterText;
+        Column      sortColumn = Column::Count;
+        bool        sortAsc = false;
+        bool        pinFirst = false;
+        bool        showPinnedOnly = false;
+    };
+
+    inline TableCache& GetTableCache() {
+        static TableCache c;
+        return c;
+    }
+
     inline void PinStyle(TableRow& r) {
         constexpr unsigned STAR = 0xF005;
         static const std::string starText = FontAwesome::UnicodeToUtf8(STAR);
@@ -79,7 +103,8 @@ namespace Live {
 
     void addTableControls(PanelState& ps);
 
-    void takeSnapshot(std::vector<TableRow>& rows);
+    // Brings the rows up to date; false if nothing changed.
+    bool takeSnapshot(TableCache& cache);
 
     void filterTable(PanelState& ps, std::vector<int>& view, const std::vector<TableRow>& rows);
 
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <ostream>
+#include <filesystem>
+#include <unordered_map>
+
+#include "statistics.hpp"
+#include "handles.hpp"
+
+namespace Logwatch {
+
+    namespace fs = std::filesystem;
+
+    /* How the counts moved over a session, for charting after the fact.
+
+       Timeline.bin is a 16 byte header followed by 32 byte records, appended and never
+       rewritten. A record is the full counts of one mod at one time, only written when
+       they changed. modId 0 is a marker: every mod before it is gone (reset, clear, deep
+       scan), and the records right after it are the whole table again.
+
+       Ids are symbol ids of the session that wrote the file, so Timeline.names maps
+       them back: { uint32 id, uint16 length, length bytes } per mod, written before the
+       first record that uses it. Both are little endian, which is all we run on. */
+
+    struct TimelineHeader {
+        char     magic[4] = { 'L', 'W', 'T', 'L' };
+        uint32_t version = 1;
+        int64_t  startMs = 0;  // unix ms of the first append
+    };
+
+    struct TimelineRecord {
+        int64_t  ms = 0;       // unix ms
+        uint32_t modId = 0;    // 0 = reset marker
+        uint32_t errors = 0;
+        uint32_t warnings = 0;
+        uint32_t fails = 0;
+        uint32_t others = 0;
+        uint32_t reserved = 0;
+    };
+
+    static_assert(sizeof(TimelineHeader) == 16);
+    static_assert(sizeof(TimelineRecord) == 32);
+
+    // Only the watch writer thread touches it.
+    class TimelineWriter {
+
+    private:
+
+        std::ofstream bin;
+        std::ofstream names;
+        std::vector<bool> named;  // by modId
+        std::vector<TimelineRecord> last;  // by modId, what we wrote last (modId 0 = nothing yet)
+        uint64_t since = 0;       // aggregator version the file is at
+        bool failed = false;      // couldn't open or write; stays off until the game restarts
+
+        bool open(const int64_t& ms);
+
+    public:
+
+        static fs::path binPath();
+        static fs::path namesPath();
+
+        // Appends whatever changed in the aggregator since the last call. The first call
+        // starts a new file, so one file is one game session. After an error it does
+        // nothing, reopening would wipe what the session already wrote.
+        void append(const int64_t& ms);
+    };
+
+    // Maps Timeline.bin read-only, so the writer can keep appending while we look.
+    class TimelineReader {
+
+    private:
+
+        ReadHandle handle;
+        MappedView view;
+        TimelineHeader head;
+        size_t count = 0;
+        std::unordered_map<uint32_t, std::string> dictionary;
+
+    public:
+
+        // False if it's missing or not a timeline. A record being written right now is
+        // left out, so is a name we only got half of.
+        bool open(const fs::path& bin, const fs::path& names);
+
+        inline const TimelineHeader& header() const noexcept { return head; }
+        inline size_t size() const noexcept { return count; }
+
+        TimelineRecord at(const size_t& i) const;
+
+        // Empty for the reset marker and for ids the dictionary doesn't have.
+        std::string_view name(const uint32_t& modId) const;
+
+        // One row per record (markers skipped): time_ms,elapsed_s,mod,errors,warnings,fails,others
+        void writeCsv(std::ostream& out) const;
+
+        // Timeline.bin + .names next to the watch snapshot into Timeline.csv, for the
+        // settings button. Runs on a thread we own; false (and nothing happens) while
+        // the last export is still going.
+        static bool exportCsvAsync();
+        static bool exporting();
+    };
+
+}
@@ -5,6 +5,9 @@
 #include <iostream>
 #include <regex>
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <iterator>
 #include <filesystem>
 
 namespace Utils {
@@ -182,26 +185,8 @@ namespace Utils {
         }
     }
 
-    inline void stripDecorativeRuns(std::string& s, size_t minRun = 4) {
-        std::string out; out.reserve(s.size());
-        for (size_t i = 0, n = s.size(); i < n; ) {
-            char c = s[i];
-            if (isDecorChar(c)) {
-                size_t j = i + 1;
-                while (j < n && s[j] == c) ++j;
-                if (j - i >= minRun) { i = j; continue; }
-                out.append(s, i, j - i);
-                i = j;
-            }
-            else {
-                out.push_back(c);
-                ++i;
-            }
-        }
-        s.swap(out);
-    }
-
-    inline std::string trimLine(const std::string_view& s) {
+    // A view into s, so a line costs nothing until it's actually kept.
+    inline std::string_view trimLine(const std::string_view& s) {
         auto l = s.begin(), r = s.end();
         while (l != r && (*l == ' ' || *l == '\t' || *l == '\r' || *l == '\n')) ++l;
         while (r != l) {
@@ -211,83 +196,272 @@ namespace Utils {
             else
                 break;
         }
-        return std::string(l, r);
+        return std::string_view(l, r);
     }
 
-    inline void collapseAndTrim(std::string& s) {
-        std::string out;
-        out.reserve(s.size());
-        bool inSpace = false;
-        for (char c : s) {
-            if (isSpace(c)) {
-                if (!inSpace) {
-                    out.push_back(' ');
-                    inSpace = true;
+    inline std::string spacify(const std::string& name) {
+        std::string s = std::regex_replace(name, std::regex("_+"), " ");
+        s = std::regex_replace(s, std::regex("([a-z])([A-Z])"), "$1 $2");
+        return s;
+    }
+
+    namespace detail {
+
+        inline bool isAsciiDigit(const char& c) { return c >= '0' && c <= '9'; }
+
+        // Cursor for the fixed timestamp/tag shapes nukeLogLine strips. Each helper is the
+        // regex piece in its comment; none of them needs backtracking.
+        struct Cursor {
+            const char* p;
+            const char* e;
+
+            inline bool done() const { return p == e; }
+
+            inline bool ch(const char& c) {
+                if (p == e || *p != c) return false;
+                ++p;
+                return true;
+            }
+
+            // [ab]
+            inline bool either(const char& a, const char& b) { return ch(a) || ch(b); }
+
+            // \d{min,max}
+            inline bool digits(const size_t& min, const size_t& max = SIZE_MAX) {
+                size_t n = 0;
+                while (p != e && n < max && isAsciiDigit(*p)) { ++p; ++n; }
+                return n >= min;
+            }
+
+            // \s* and \s+
+            inline void spaces() { while (p != e && isSpace(*p)) ++p; }
+            inline bool spaces1() { const char* s = p; spaces(); return p != s; }
+
+            // a lowercase literal, matched case-insensitively
+            inline bool word(const char* w) {
+                const char* q = p;
+                for (; *w; ++w, ++q) {
+                    if (q == e || toLowerC(*q) != *w) return false;
                 }
+                p = q;
+                return true;
+            }
+
+            // (?:[.:]\d+)? right before a closing bracket
+            inline bool fraction() {
+                if (either('.', ':')) return digits(1);
+                return true;
+            }
+
+            // \d{2}[:-]\d{2}[:-]\d{2}
+            inline bool clock(const bool& dashes) {
+                return digits(2, 2) && (dashes ? either(':', '-') : ch(':'))
+                    && digits(2, 2) && (dashes ? either(':', '-') : ch(':'))
+                    && digits(2, 2);
+            }
+        };
+
+        // [2024-01-31 12:00:00.123]
+        inline bool isoStamp(Cursor c) {
+            return c.digits(4, 4) && c.ch('-') && c.digits(2, 2) && c.ch('-') && c.digits(2, 2)
+                && c.spaces1() && c.clock(true) && c.fraction() && c.done();
+        }
+
+        // [2024-01-31/12:00:00.123]
+        inline bool isoSlashStamp(Cursor c) {
+            return c.digits(4, 4) && c.ch('-') && c.digits(2, 2) && c.ch('-') && c.digits(2, 2)
+                && c.ch('/') && c.clock(false) && c.fraction() && c.done();
+        }
+
+        // [1/31/2024 12:00:00]
+        inline bool usStamp(Cursor c) {
+            return c.digits(1, 2) && c.ch('/') && c.digits(1, 2) && c.ch('/') && c.digits(2, 4)
+                && c.spaces1() && c.clock(true) && c.fraction() && c.done();
+        }
+
+        // [12:00:00.123 +01:00]
+        inline bool timeStamp(Cursor c) {
+            if (!c.clock(false)) return false;
+            if (c.either(':', '.') && !c.digits(1)) return false;
+
+            // (?:\s*[+-]\d{2}:\d{2})?
+            const char* save = c.p;
+            c.spaces();
+            if (c.either('+', '-')) {
+                if (!(c.digits(2, 2) && c.ch(':') && c.digits(2, 2))) return false;
             }
             else {
-                out.push_back(c);
-                inSpace = false;
+                c.p = save;
             }
+            return c.done();
+        }
+
+        // [pid: 123 | tid: 456]
+        inline bool pidTid(Cursor c) {
+            c.spaces();
+            if (!c.word("pid")) return false;
+            c.spaces();
+            if (!c.ch(':')) return false;
+            c.spaces();
+            if (!c.digits(1)) return false;
+            c.spaces();
+            if (!c.ch('|')) return false;
+            c.spaces();
+            if (!c.word("tid")) return false;
+            c.spaces();
+            if (!c.ch(':')) return false;
+            c.spaces();
+            if (!c.digits(1)) return false;
+            c.spaces();
+            return c.done();
+        }
+
+        // [ Info ]
+        inline bool bracketWord(Cursor c) {
+            c.spaces();
+            const char* from = c.p;
+            while (!c.done() && ((*c.p >= 'a' && *c.p <= 'z') || (*c.p >= 'A' && *c.p <= 'Z') || *c.p == '_')) ++c.p;
+            if (c.p == from) return false;
+            c.spaces();
+            return c.done();
+        }
+
+        // [ 42 ]
+        inline bool bracketNumber(Cursor c) {
+            c.spaces();
+            if (!c.digits(1)) return false;
+            c.spaces();
+            return c.done();
+        }
+
+        // Bracket removals in the order the old regex passes ran. Pass 5 was the leading
+        // (unbracketed) US timestamp, which is handled separately.
+        inline int bracketPass(const char* b, const char* e, const int& after) {
+            const Cursor c{ b, e };
+            if (after < 1 && isoStamp(c))      return 1;
+            if (after < 2 && isoSlashStamp(c)) return 2;
+            if (after < 3 && usStamp(c))       return 3;
+            if (after < 4 && timeStamp(c))     return 4;
+            if (after < 6 && pidTid(c))        return 6;
+            if (after < 7 && bracketWord(c))   return 7;
+            if (after < 8 && bracketNumber(c)) return 8;
+            return 0;
+        }
+
+        // ^\s*\d{1,2}/\d{1,2}/\d{2,4}\s*-\s*\d{2}:\d{2}:\d{2}(?:[.:]\d+)?\s*  (length, 0 if none)
+        inline size_t leadingUsStamp(const char* b, const char* e) {
+            Cursor c{ b, e };
+            c.spaces();
+            if (!(c.digits(1, 2) && c.ch('/') && c.digits(1, 2) && c.ch('/') && c.digits(2, 4))) return 0;
+            c.spaces();
+            if (!c.ch('-')) return 0;
+            c.spaces();
+            if (!c.clock(false)) return 0;
+            if (c.e - c.p >= 2 && (*c.p == '.' || *c.p == ':') && isAsciiDigit(c.p[1])) {
+                ++c.p;
+                c.digits(1);
+            }
+            c.spaces();
+            return size_t(c.p - b);
         }
-        size_t b = 0, e = out.size();
-        while (b < e && out[b] == ' ') ++b;
-        while (e > b && out[e - 1] == ' ') --e;
-        s.assign(out.begin() + b, out.begin() + e);
-    }
 
-    inline std::string spacify(const std::string& name) {
-        std::string s = std::regex_replace(name, std::regex("_+"), " ");
-        s = std::regex_replace(s, std::regex("([a-z])([A-Z])"), "$1 $2");
-        return s;
     }
 
+    /* Used to be eight regex_replace passes plus two more copies. Now it's one scan that
+       rewrites s in place and one in-place pass for decorative runs and whitespace, with
+       the exact same output.
+       Every bracket regex matched a [...] with no brackets inside, so a pass could only
+       remove innermost groups, and removing those could expose their parent to the
+       *later* passes only. A stack of open brackets replays that: when a group closes
+       we know which pass (if any) emptied it last, and only passes after that one get
+       to look at it. The leading timestamp ran fifth, so it sees everything up to the
+       first '[' that survived passes 1-4. */
     inline std::string nukeLogLine(std::string s, const bool& removeCppStuff = true) {
-        if (removeCppStuff) {
+        if (removeCppStuff && s.find('.') != std::string::npos) {
             stripLeadingCppPath(s);
             stripBracketedCpp(s);
             stripParendCpp(s);
         }
 
-        static const std::regex ts_iso_br(
-            "\\[\\d{4}-\\d{2}-\\d{2}\\s+\\d{2}[:-]\\d{2}[:-]\\d{2}(?:[.:]\\d+)?\\]",
-            std::regex::icase
-        );
-        static const std::regex ts_iso_slash_br(
-            "\\[\\d{4}-\\d{2}-\\d{2}/\\d{2}:\\d{2}:\\d{2}(?:[.:]\\d+)?\\]",
-            std::regex::icase
-        );
-        static const std::regex ts_us_br(
-            "\\[\\d{1,2}/\\d{1,2}/\\d{2,4}\\s+\\d{2}[:-]\\d{2}[:-]\\d{2}(?:[.:]\\d+)?\\]",
-            std::regex::icase
-        );
-        static const std::regex ts_time_br(
-            "\\[\\d{2}:\\d{2}:\\d{2}(?::\\d+|\\.\\d+)?(?:\\s*[+-]\\d{2}:\\d{2})?\\]",
-            std::regex::icase
-        );
-        static const std::regex ts_us_leading(
-            "^\\s*\\d{1,2}/\\d{1,2}/\\d{2,4}\\s*-\\s*\\d{2}:\\d{2}:\\d{2}(?:[.:]\\d+)?\\s*",
-            std::regex::icase
-        );
-        static const std::regex pidtid_br(
-            "\\[\\s*pid\\s*:\\s*\\d+\\s*\\|\\s*tid\\s*:\\s*\\d+\\s*\\]",
-            std::regex::icase
-        );
-        static const std::regex word_re("\\[\\s*[A-Za-z_]+\\s*\\]");
-        static const std::regex num_re("\\[\\s*\\d+\\s*\\]");
-
-        // Order doesn't matter here.
-        s = std::regex_replace(s, ts_iso_br, "");
-        s = std::regex_replace(s, ts_iso_slash_br, "");
-        s = std::regex_replace(s, ts_us_br, "");
-        s = std::regex_replace(s, ts_time_br, "");
-        s = std::regex_replace(s, ts_us_leading, "");
-        s = std::regex_replace(s, pidtid_br, "");
-        s = std::regex_replace(s, word_re, "");
-        s = std::regex_replace(s, num_re, "");
-
-		stripDecorativeRuns(s, 4);
-        collapseAndTrim(s);
+        struct Open {
+            size_t pos;           // where its '[' sits in the output
+            int    after = 0;     // last pass that removed one of its children
+            bool   stuck = false; // a child survived, so this one never becomes innermost
+        };
+
+        // Brackets rarely nest more than a couple deep; only a silly line spills to the heap.
+        Open inlineOpen[16];
+        std::vector<Open> spilled;
+        Open* open = inlineOpen;
+        size_t depth = 0, capacity = std::size(inlineOpen);
+
+        size_t w = 0;
+        size_t leadLimit = std::string::npos; // first '[' still there when pass 5 ran
+
+        const auto closed = [&](const int& pass, const size_t& pos) {
+            if (depth > 0) {
+                auto& parent = open[depth - 1];
+                if (pass) parent.after = std::max(parent.after, pass);
+                else parent.stuck = true;
+            }
+            else if (leadLimit == std::string::npos && (pass == 0 || pass > 5)) {
+                leadLimit = pos;
+            }
+        };
+
+        for (size_t r = 0, n = s.size(); r < n; ++r) {
+            const char c = s[r];
+            s[w++] = c;
+
+            if (c == '[') {
+                if (depth == capacity) {
+                    if (open == inlineOpen) spilled.assign(open, open + depth);
+                    spilled.resize(capacity *= 2);
+                    open = spilled.data();
+                }
+                open[depth++] = Open{ w - 1 };
+            }
+            else if (c == ']') {
+                if (depth == 0) continue;
+
+                const auto g = open[--depth];
+                const int pass = g.stuck ? 0 : detail::bracketPass(s.data() + g.pos + 1, s.data() + w - 1, g.after);
+                if (pass) w = g.pos;
+                closed(pass, g.pos);
+            }
+        }
+
+        // Whatever is still open was never closed, so it stays.
+        if (leadLimit == std::string::npos) leadLimit = depth > 0 ? open[0].pos : w;
+
+        size_t r = detail::leadingUsStamp(s.data(), s.data() + leadLimit);
+
+        // Decorative runs (4+ of the same char) go, whitespace collapses, ends get trimmed.
+        const size_t end = w;
+        w = 0;
+        bool space = false;
+        while (r < end) {
+            const char c = s[r];
+            if (isDecorChar(c)) {
+                size_t j = r + 1;
+                while (j < end && s[j] == c) ++j;
+                if (j - r >= 4) { r = j; continue; }
+                if (space && w) s[w++] = ' ';
+                space = false;
+                while (r < j) s[w++] = s[r++];
+                continue;
+            }
+            if (isSpace(c)) {
+                space = true;
+            }
+            else {
+                if (space && w) s[w++] = ' ';
+                space = false;
+                s[w++] = c;
+            }
+            ++r;
+        }
+        s.resize(w);
         return s;
     }
 
@@ -20,6 +20,13 @@
 #include "plugin.hpp"
 #include "statistics.hpp"
 #include "mail.hpp"
+#include "notifier.hpp"
+#include "discovery.hpp"
+#include "filestatus.hpp"
+#include "handles.hpp"
+#include "classifier.hpp"
+#include "symbols.hpp"
+#include "watchwriter.hpp"
 
 namespace Logwatch {
 
@@ -27,13 +34,13 @@ namespace Logwatch {
     enum class RunState { Running, AutoStopPending, Stopped };
 
     // Matches a log line.
-    void OnMatch(const Match& m);
+    void OnMatch(Match&& m);
 
     // Papyrus or Generic?
     LogType classify(const std::filesystem::path& p);
 
     // For the OnMatach or any other callable.
-    using Callback = std::function<void(const Match&)>;
+    using Callback = std::function<void(Match&&)>;
 
     class LogWatcher {
 
@@ -60,12 +67,36 @@ namespace Logwatch {
         // This is one reason why I needed jthread.
         std::condition_variable_any _wake_cv_;
 
-        Config   config;
-        Callback callback;
+        Config     config;
+        Classifier classifier; // compiled from config.patterns in start(), unless they're the defaults
+        bool       defaultLevels{ false };
+        std::vector<uint32_t> patternIds;    // config.patterns names, interned in start()
+        std::vector<Level>    patternLevels; // and the level each one reports as
+        Callback   callback;
 
         // Bookkeeping.
         std::vector<fs::path>                         roots;
         std::unordered_map<std::string, FileInfo>     files;
+        DirCache                                      dirCache;
+
+        // One stat per file per poll; only touched by the worker.
+        FileStatusCache                               statusCache;
+        std::atomic<uint64_t>                         lastPollStatCalls{ 0 };
+
+        // Prefilter totals since start, published after each poll.
+        std::atomic<uint64_t>                         linesClassified{ 0 };
+        std::atomic<uint64_t>                         linesFullyMatched{ 0 };
+
+        // Read handles kept open across polls, the buffer chunks are read into and
+        // the line breaks found in it; worker only (clear() runs after stop()).
+        HandlePool                                    handles;
+        ChunkBuffer                                   chunkBuf;
+        std::vector<size_t>                           lineBreaks;
+
+        // Event-driven wakeups; declared after the wake cv since its thread pokes it.
+        ChangeNotifier    notifier;
+        bool              notifierUnavailable{ false };
+        Clock::time_point nextFullScanAt{ };
 
         // Delay notifications until save is loaded.
         std::atomic<bool> gameReady{ false };
@@ -75,43 +106,48 @@ namespace Logwatch {
         Counts periodicLastTotals{};
         Clock::time_point periodicNextAt{ };
         bool periodicReady{ false };
-        std::unordered_map<std::string, Counts> periodicLastPerMod;
+        std::unordered_map<uint32_t, Counts> periodicLastPerMod;  // by modId
+        uint64_t periodicBaseVersion{ 0 };  // aggregator version periodicLastPerMod is at
         
         // Pinned alerts.
-        std::unordered_map<std::string, PinnedSnapshot> pinnedState;
+        std::unordered_map<uint32_t, PinnedSnapshot> pinnedState;  // by modId
+        uint64_t pinnedVersion{ 0 };        // aggregator version of the last pass
+        uint64_t pinnedPinsVersion{ 0 };    // and the pins as of then
         std::deque<HUDMessage> hudMessages;
 
         // Mail.
         MailBox mailbox;
 
         // For saving watch.
-        size_t lastWatchHash{ 0 };
-
-        size_t hashWatchSnapshot(const Snapshot& snap) const;
-		void getSortedSnapshot(std::vector<std::pair<std::string, Counts>>& out, const Snapshot& snap) const;
-        void saveWatchIfChanged(const Snapshot& snap);
-        std::string watchSnapshotPath(const std::string& ext) const;
-        std::string watchTimeStamp() const;
+        WatchWriter watchWriter;
+        uint64_t lastWatchHash{ 0 };  // Aggregator::watchHash() as of the last submit
+        void saveWatchIfChanged();
 
         // Worker body.
         void watcherLoop(const std::stop_token& stop);
+        bool useNotifier();
+        void sleepUntilNextPoll(const std::stop_token& stop, const bool& evented);
 
         // Scan functions
         void scanOnce(const std::stop_token& stop);
+        void scanChanged(const std::vector<fs::path>& changed, const std::stop_token& stop);
+        void trackFile(const fs::path& p, const std::string& canon);
+        void pollFile(const std::string& key, const std::stop_token& stop);
         bool shouldInclude(const fs::path& file) const;
-        void discoverFiles(std::vector<fs::path>& out, const fs::path& root, const std::stop_token& stop);
-        void tailFile(FileInfo& fi, const std::stop_token& stop);
+        void discoverFiles(std::vector<DiscoveredFile>& out, const fs::path& root, const std::stop_token& stop);
+        void tailFile(const std::string& key, FileInfo& fi, const FileStatus& status, const std::stop_token& stop);
 
-        // TODO: make chunk constant.
-        void parseBufferAndEmit(FileInfo& fi, std::string&& chunk, const std::stop_token& stop);
+        // The chunk is a view into chunkBuf or a mapped region, don't keep it around.
+        void parseBufferAndEmit(FileInfo& fi, const std::string_view& chunk, const std::stop_token& stop);
+        void emitLine(FileInfo& fi, const std::string_view& raw);
 
         // Line here has to be string_view to avoid reallocation.
-        void emitIfMatch(const fs::path& file, const std::string_view& line, const uint64_t& lineNo);
+        void emitIfMatch(const FileInfo& fi, const std::string_view& line, const uint64_t& lineNo);
 
         // Notification functions
-        void updatePeriodicBase(const Snapshot& snap, const Clock::time_point& now, const int& interval);
-        void mayNotifyPinnedAlerts(const Snapshot& snap);
-        void mayNorifyPeriodicAlerts(const Snapshot& snap);
+        void updatePeriodicBase(const Changes& ch, const Clock::time_point& now, const int& interval);
+        void mayNotifyPinnedAlerts();
+        void mayNorifyPeriodicAlerts();
 
         inline void scheduleNotification(HUDMessage&& m) {
             std::lock_guard lock(_mutex_);
@@ -136,11 +172,11 @@ namespace Logwatch {
             }
         }
 
-        inline void updatePinnedBase(const std::string& modKey, const Counts& curr, const Clock::time_point& now) {
+        inline void updatePinnedBase(const uint32_t& modId, const Counts& curr, const Clock::time_point& now) {
             PinnedSnapshot ps;
             ps.counts = curr;
             ps.lastAlertAt = now;
-            pinnedState[modKey] = ps;
+            pinnedState[modId] = ps;
         }
 
         inline void computeDiff(Counts& d, const Counts& curr, const Counts& prev) {
@@ -202,6 +238,18 @@ namespace Logwatch {
                 return;
             }
             logger::info("Starting Watcher thread");
+            patternIds.clear();
+            patternLevels.clear();
+            for (const auto& p : config.patterns) {
+                patternIds.push_back(symbols.intern(p.name));
+                if (p.name == "error")        patternLevels.push_back(Level::kError);
+                else if (p.name == "warning") patternLevels.push_back(Level::kWarning);
+                else if (p.name == "fail")    patternLevels.push_back(Level::kFail);
+                else                          patternLevels.push_back(Level::kOther);
+            }
+            defaultLevels = config.hasDefaultPatterns();
+            if (defaultLevels) logger::info("Using the built-in level matcher");
+            else classifier.build(config.patterns);
             worker = std::jthread(
                 [this](const std::stop_token& st) { 
                     try {
@@ -247,6 +295,8 @@ namespace Logwatch {
         void clear() {
             std::lock_guard lock(_mutex_);
             files.clear();
+            dirCache.clear();
+            handles.clear();
         }
 
         inline size_t discoveredFileCount() {
@@ -254,6 +304,22 @@ namespace Logwatch {
             return files.size();
         }
 
+        // Native stat calls made by the last poll (files and directories).
+        inline uint64_t statCallsPerPoll() const noexcept {
+            return lastPollStatCalls.load(std::memory_order_relaxed);
+        }
+
+        // Lines the generic classifier saw; stays 0 while the built-in matcher does the work.
+        inline uint64_t prefilterLines() const noexcept {
+            return linesClassified.load(std::memory_order_relaxed);
+        }
+
+        // Share of lines the keyword prefilter couldn't settle on its own (0..1).
+        inline double prefilterPassRatio() const noexcept {
+            const auto seen = linesClassified.load(std::memory_order_relaxed);
+            return seen ? double(linesFullyMatched.load(std::memory_order_relaxed)) / double(seen) : 0.0;
+        }
+
         inline void nudge() {
             _wake_cv_.notify_all();
         }
@@ -262,7 +328,10 @@ namespace Logwatch {
             periodicReady = false;
             periodicLastPerMod.clear();
             periodicLastTotals = {};
+            periodicBaseVersion = 0;
             pinnedState.clear();
+            pinnedVersion = 0;
+            pinnedPinsVersion = 0;
         }
 
         std::vector<Logwatch::MailEntry> snapshotMailbox() const {
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <fstream>
+#include <string_view>
+#include <stop_token>
+#include <condition_variable>
+
+#include "statistics.hpp"
+#include "timeline.hpp"
+
+namespace Logwatch {
+
+    // Writes WatchSnapshot.log/.csv and appends to the timeline on its own thread so the
+    // watcher never waits on the disk. Only the newest table is kept: anything submitted
+    // while a write is pending replaces it, so an error storm costs one write per
+    // interval, not one per poll.
+    class WatchWriter {
+
+    private:
+
+        // At most one write per this much; the last table always makes it out eventually.
+        static constexpr auto kMinInterval = std::chrono::seconds(2);
+
+        std::jthread worker;
+
+        std::mutex                  _mutex_;
+        std::condition_variable_any _wake_cv_;
+
+        // Newest table nobody wrote yet, when it was taken and what to write it into.
+        std::shared_ptr<const CountsTable>    pending;
+        std::chrono::system_clock::time_point pendingAt;
+        bool                                  pendingSnapshot{ false };
+        bool                                  pendingTimeline{ false };
+
+        // Lives as long as we do, so a watcher restart (deep scan) keeps the same file.
+        TimelineWriter timeline;
+
+        std::chrono::steady_clock::time_point lastWriteAt{ };
+
+        void run(const std::stop_token& stop);
+        void write(const CountsTable& table, const std::chrono::system_clock::time_point& at) const;
+        void appendTimeline(const std::chrono::system_clock::time_point& at);
+
+        static std::string path(const std::string_view& ext);
+        static std::string timeStamp(const std::chrono::system_clock::time_point& at);
+
+        // Writes into path.tmp and renames it over path, so readers never see half a file.
+        static bool replaceFile(const std::string& path, const std::string& contents);
+
+    public:
+
+        WatchWriter() = default;
+        ~WatchWriter() { stop(); }
+
+        WatchWriter(const WatchWriter&) = delete;
+        WatchWriter& operator=(const WatchWriter&) = delete;
+
+        void start();
+
+        // Writes whatever is still pending before returning.
+        void stop();
+
+        // Never blocks on I/O; just swaps the pointer and wakes the writer. The snapshot
+        // files get the table, the timeline whatever changed since its last append.
+        void submit(std::shared_ptr<const CountsTable> table, const bool& snapshot, const bool& timeline);
+    };
+
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include "ui.hpp"
 #include "translate.hpp"
+#include "statistics.hpp"
 
 namespace Live {
 
@@ -40,11 +41,13 @@ namespace Live {
         return p;
     }
 
-    inline bool LevelEnabled(const DetailsState& ds, const std::string& lvl) {
-        if (lvl == "error")   return ds.showError;
-        if (lvl == "warning") return ds.showWarning;
-        if (lvl == "fail")    return ds.showFail;
-        return ds.showOther;
+    inline bool LevelEnabled(const DetailsState& ds, const Logwatch::Level& lvl) {
+        switch (lvl) {
+        case Logwatch::Level::kError:   return ds.showError;
+        case Logwatch::Level::kWarning: return ds.showWarning;
+        case Logwatch::Level::kFail:    return ds.showFail;
+        default:                        return ds.showOther;
+        }
     }
 
     void multiSelectCombo(DetailsState& ds);
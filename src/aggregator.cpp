@@ -1,51 +1,300 @@
+#include <algorithm>
+
 #include "aggregator.hpp"
+#include "symbols.hpp"
 
 Logwatch::Aggregator Logwatch::aggr(500);
 
-void Logwatch::Aggregator::add(const Match& m) {
-    const std::string key = keyOfFast(m.file);
+void Logwatch::Aggregator::add(Match&& m) {
+    while (!inbox.push(std::move(m))) commit();
+}
 
-    std::unique_lock lock(_mutex_);
-	auto& s = mods.try_emplace(key).first->second; // avois creating temporary copies of ModStats
+void Logwatch::Aggregator::commit() {
+    std::lock_guard drain(_commit_mutex_);
 
-	uint8_t mask = Level::kOther;
-	if (m.level == "error") { ++s.errors; mask = Level::kError; }
-	else if (m.level == "warning") { ++s.warnings; mask = Level::kWarning; }
-	else if (m.level == "fail") { ++s.fails; mask = Level::kFail; }
-	else { ++s.others; }
+    // Pop outside the big lock; readers only wait for the apply.
+    batch.clear();
+    Match m;
+    while (batch.size() < kInboxSize && inbox.pop(m)) batch.push_back(std::move(m));
+    if (batch.empty()) return;
 
-    s.last.emplace_back( ModStats::Record{ m.level, m.file, m.line, m.lineNo, m.when, mask });
+    const size_t limit = batchLimit.load(std::memory_order_relaxed);
+    for (size_t from = 0; from < batch.size(); from += limit) {
+        const size_t to = std::min(batch.size(), from + limit);
 
-    const auto c = cap.load(std::memory_order_relaxed);
-    while (s.last.size() > c) s.last.pop_front();
+        const auto t0 = std::chrono::steady_clock::now();
+        {
+            std::unique_lock lock(_mutex_);
+            for (size_t i = from; i < to; ++i) apply(batch[i]);
+            touch();
+        }
+        const auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count());
+
+        commits.fetch_add(1, std::memory_order_relaxed);
+        committed.fetch_add(to - from, std::memory_order_relaxed);
+        holdNs.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > maxHoldNs.load(std::memory_order_relaxed)) maxHoldNs.store(ns, std::memory_order_relaxed);
+    }
 }
 
+uint64_t Logwatch::Aggregator::hashName(const std::string_view& key) {
+    uint64_t h = FNV_OFFSET;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= FNV_PRIME;
+    }
+    return h;
+}
 
-std::vector<Logwatch::ModStats::Record>
-Logwatch::Aggregator::recent(const std::string& modKey, const size_t& limit) const {
-    std::shared_lock lock(_mutex_);
-    std::vector<ModStats::Record> out;
-    auto it = mods.find(modKey);
-    if (it == mods.end() || limit == 0) return out;
+// Same as FNV-1a, but we mix in counts on top of the name.
+uint64_t Logwatch::Aggregator::hashOf(const ModStats& s) {
+    uint64_t h = s.nameHash;
 
-    const auto& dq = it->second.last;
-    const auto n = std::min(limit, dq.size());
-    out.resize(n);
-    std::copy_n(dq.rbegin(), n, out.begin());
-    return out;
+#define mix(count) h ^= uint64_t(uint32_t(count)); h *= FNV_PRIME;
+
+    mix(s.errors);
+    mix(s.warnings);
+    mix(s.fails);
+    mix(s.others);
+
+#undef mix
+
+    return h;
+}
+
+void Logwatch::Aggregator::dropPending() {
+    std::lock_guard drain(_commit_mutex_);
+    Match m;
+    while (inbox.pop(m)) {}
+}
+
+void Logwatch::Aggregator::apply(const Match& m) {
+    const std::string& key = symbols.name(m.modId); // interned, no copy unless the mod is new
+
+	auto [at, fresh] = mods.try_emplace(key); // avois creating temporary copies of ModStats
+	auto& s = at->second;
+	if (fresh) s.nameHash = hashName(key);
+	s.modId = m.modId;
+	s.version = nextVersion();
+	const uint64_t was = s.hash;
+
+	switch (m.level) {
+	case Level::kError:   ++s.errors; break;
+	case Level::kWarning: ++s.warnings; break;
+	case Level::kFail:    ++s.fails; break;
+	default:              ++s.others; break;
+	}
+
+	s.hash = hashOf(s);
+	rolling.fetch_add(s.hash - was, std::memory_order_relaxed); // wraps both ways, fine for a sum
+
+    auto [it, added] = history.try_emplace(key);
+    auto& h = it->second;
+    if (added) h.entries.setCapacity(cap.load(std::memory_order_relaxed));
+    if (h.entries.capacity() == 0) return;
+
+    const auto before = h.text.bytes();
+    if (h.entries.full()) h.popOldest(); // count cap; the slot gets reused right below
+
+    auto& e = h.entries.push();
+    e.seq = nextSeq++;
+    e.lineNo = m.lineNo;
+    e.when = m.when;
+    e.text = h.text.append(m.line);
+    e.fileId = m.fileId;
+    e.level = m.level;
+    e.normalized = false;
+
+    textBytes = textBytes + h.text.bytes() - before;
+    if (!h.queued) {
+        oldest.push({ e.seq, &h });
+        h.queued = true;
+    }
+
+    enforceBudget();
+}
+
+std::shared_ptr<const Logwatch::Aggregator::Published> Logwatch::Aggregator::publish() const {
+    auto fresh = std::make_shared<Published>();
+    {
+        std::shared_lock lock(_mutex_);
+        fresh->version = version.load(std::memory_order_acquire);
+        fresh->resetAt = resetAt;
+        fresh->table.reserve(mods.size());
+        for (const auto& [key, s] : mods) fresh->table.push_back(countsOf(key, s));
+    }
+    std::sort(fresh->table.begin(), fresh->table.end(),
+        [](const ModCounts& a, const ModCounts& b) { return a.modId < b.modId; });
+
+    // Two readers may race to build it; never replace a newer one.
+    std::shared_ptr<const Published> cur = published.load(std::memory_order_acquire);
+    while (!cur || cur->version < fresh->version) {
+        if (published.compare_exchange_weak(cur, fresh, std::memory_order_acq_rel)) break;
+    }
+    return fresh;
+}
+
+Logwatch::ModCounts Logwatch::Aggregator::countsOf(const std::string& modKey, const ModStats& s) const {
+    ModCounts c;
+    c.modId = s.modId;
+    c.errors = s.errors;
+    c.warnings = s.warnings;
+    c.fails = s.fails;
+    c.others = s.others;
+    c.version = s.version;
+    const auto h = history.find(modKey);
+    if (h != history.end()) {
+        c.cached = h->second.entries.size();
+        c.version = std::max(c.version, h->second.version);
+    }
+    return c;
+}
+
+Logwatch::Changes Logwatch::Aggregator::changedSince(const uint64_t& since) const {
+    const auto p = current();
+
+    Changes ch;
+    ch.version = p->version;
+    ch.all = std::shared_ptr<const CountsTable>(p, &p->table);
+    if (since >= p->version) return ch;
+
+    ch.full = since < p->resetAt;
+    for (const auto& row : p->table) {
+        if (ch.full || row.version > since) ch.changed.push_back(row);
+    }
+    return ch;
+}
+
+bool Logwatch::Aggregator::evictOldest() {
+    while (!oldest.empty()) {
+        const auto top = oldest.top();
+        oldest.pop();
+
+        auto& h = *top.mod;
+        if (h.entries.empty()) {
+            h.queued = false;
+            continue;
+        }
+
+        // Stale key: the ring evicted on its own since. Put it back where it belongs.
+        const auto seq = h.entries.oldest().seq;
+        if (seq != top.seq) {
+            oldest.push({ seq, top.mod });
+            continue;
+        }
+
+        const auto before = h.text.bytes();
+        h.popOldest();
+        h.version = nextVersion(); // its cached count just dropped
+        textBytes -= before - h.text.bytes();
+
+        if (h.entries.empty()) h.queued = false;
+        else oldest.push({ h.entries.oldest().seq, top.mod });
+        return true;
+    }
+    return false;
+}
+
+void Logwatch::Aggregator::enforceBudget() {
+    // A record only gives memory back once its whole slab is unused, so this can take a few.
+    const auto b = budget.load(std::memory_order_relaxed);
+    while (textBytes > b && evictOldest()) {}
+}
+
+void Logwatch::Aggregator::requeue() {
+    oldest = {};
+    textBytes = 0;
+    for (auto& [_, h] : history) {
+        textBytes += h.text.bytes();
+        h.queued = !h.entries.empty();
+        if (h.queued) oldest.push({ h.entries.oldest().seq, &h });
+    }
+}
+
+void Logwatch::Aggregator::restoreAndClear() {
+    dropPending();
+    std::unique_lock lock(_mutex_);
+    if (!backup.empty()) {
+        mods = std::move(backup);
+        backup.clear();
+        history = std::move(historyBackup);
+        historyBackup.clear();
+        rolling.store(rollingBackup, std::memory_order_relaxed);
+        const auto c = cap.load(std::memory_order_relaxed);
+        for (auto& [_, h] : history) h.trim(c);
+    }
+    else {
+        mods.clear();
+        history.clear();
+        rolling.store(FNV_OFFSET, std::memory_order_relaxed);
+    }
+    rollingBackup = FNV_OFFSET;
+    requeue();
+    enforceBudget();
+    touchAll();
 }
 
+void Logwatch::Aggregator::setCapacity(const size_t& n) {
+    std::unique_lock lock(_mutex_);
+    cap.store(n, std::memory_order_relaxed);
+    for (auto& [_, h] : history) h.trim(n);
+    requeue();
+    touchAll();
+    logger::info("Aggregator capacity set to {}", n);
+}
+
+
 std::vector<Logwatch::ModStats::Record>
-Logwatch::Aggregator::recentLevel(const std::string& modKey, const size_t& limit, const uint8_t& reqMask) const {
-    std::shared_lock lock(_mutex_);
+Logwatch::Aggregator::collect(const std::string& modKey, const size_t& limit, const uint8_t& mask) const {
     std::vector<ModStats::Record> out;
-    auto it = mods.find(modKey);
-    if (it == mods.end() || limit == 0) return out;
+    if (limit == 0) return out;
 
-    const auto& dq = it->second.last;
-    out.reserve(std::min(limit, dq.size()));
-    for (auto rit = dq.rbegin(); rit != dq.rend() && out.size() < limit; ++rit) {
-        if (rit->levelMask & reqMask) out.push_back(*rit);
+    const auto toRecord = [](const ModHistory::Entry& e, const std::string_view& text) {
+        return ModStats::Record{ e.fileId, std::string(text), e.lineNo, e.when, e.level };
+    };
+
+    // Pass 1 under the shared lock: usually everything shown was shown before, so there
+    // is nothing to normalize and we're done.
+    {
+        std::shared_lock lock(_mutex_);
+        auto it = history.find(modKey);
+        if (it == history.end()) return out;
+
+        bool pending = false;
+        const auto& h = it->second;
+        out.reserve(std::min(limit, h.entries.size()));
+        for (size_t i = 0; i < h.entries.size() && out.size() < limit; ++i) {
+            const auto& e = h.entries.newest(i);
+            if (!(e.level & mask)) continue;
+            if (!e.normalized) { pending = true; break; }
+            out.push_back(toRecord(e, h.text.view(e.text)));
+        }
+        if (!pending) return out;
+    }
+
+    // Pass 2 under the unique lock, normalizing what we hand out. The ring may have moved
+    // on in between, so start over.
+    out.clear();
+    std::unique_lock lock(_mutex_);
+    auto it = history.find(modKey);
+    if (it == history.end()) return out;
+
+    auto& h = it->second;
+    for (size_t i = 0; i < h.entries.size() && out.size() < limit; ++i) {
+        auto& e = h.entries.newest(i);
+        if (!(e.level & mask)) continue;
+        out.push_back(toRecord(e, h.display(e)));
     }
     return out;
 }
+
+std::vector<Logwatch::ModStats::Record>
+Logwatch::Aggregator::recent(const std::string& modKey, const size_t& limit) const {
+    return collect(modKey, limit, Level::kError | Level::kWarning | Level::kFail | Level::kOther);
+}
+
+std::vector<Logwatch::ModStats::Record>
+Logwatch::Aggregator::recentLevel(const std::string& modKey, const size_t& limit, const uint8_t& reqMask) const {
+    return collect(modKey, limit, reqMask);
+}
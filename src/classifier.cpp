@@ -0,0 +1,892 @@
+#include <cctype>
+#include <random>
+#include <algorithm>
+
+#include "classifier.hpp"
+#include "logger.hpp"
+
+namespace {
+
+    using Logwatch::Rx::CharSet;
+    using Logwatch::Rx::Node;
+    using Logwatch::Rx::Op;
+
+    CharSet digits() {
+        CharSet s;
+        for (int c = '0'; c <= '9'; ++c) s.set(c);
+        return s;
+    }
+
+    CharSet words() {
+        CharSet s;
+        for (int c = 0; c < 256; ++c) if (Logwatch::Rx::isWord(static_cast<unsigned char>(c))) s.set(c);
+        return s;
+    }
+
+    CharSet spaces() {
+        CharSet s;
+        for (const char c : { ' ', '\t', '\n', '\v', '\f', '\r' }) s.set(static_cast<unsigned char>(c));
+        return s;
+    }
+
+    // std::regex icase folds through the "C" locale, i.e. ASCII letters only.
+    CharSet fold(CharSet s) {
+        for (int c = 'a'; c <= 'z'; ++c) {
+            if (s[c] || s[c - 'a' + 'A']) {
+                s.set(c);
+                s.set(c - 'a' + 'A');
+            }
+        }
+        return s;
+    }
+
+    int hexValue(const char& c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    struct Parser {
+
+        std::string_view s;
+        size_t i = 0;
+        bool icase = false;
+
+        inline bool eof() const { return i >= s.size(); }
+
+        Node setNode(const CharSet& cs) const {
+            Node n;
+            n.op = Op::Set;
+            n.set = icase ? fold(cs) : cs;
+            return n;
+        }
+
+        // Escapes that are a single byte, shared by atoms and classes. -1 if it isn't one.
+        int simpleEscape(const char& c) {
+            switch (c) {
+            case 'n': return '\n';
+            case 'r': return '\r';
+            case 't': return '\t';
+            case 'f': return '\f';
+            case 'v': return '\v';
+            case '0':
+                if (!eof() && s[i] >= '0' && s[i] <= '9') return -1;
+                return 0;
+            case 'x': {
+                if (i + 2 > s.size()) return -1;
+                const int hi = hexValue(s[i]), lo = hexValue(s[i + 1]);
+                if (hi < 0 || lo < 0) return -1;
+                i += 2;
+                return hi * 16 + lo;
+            }
+            default:
+                // identity escapes of punctuation
+                if (!std::isalnum(static_cast<unsigned char>(c))) return static_cast<unsigned char>(c);
+                return -1;
+            }
+        }
+
+        bool classEscape(const char& c, CharSet& out) {
+            switch (c) {
+            case 'd': out = digits(); return true;
+            case 'D': out = ~digits(); return true;
+            case 'w': out = words(); return true;
+            case 'W': out = ~words(); return true;
+            case 's': out = spaces(); return true;
+            case 'S': out = ~spaces(); return true;
+            default: return false;
+            }
+        }
+
+        bool parseClass(Node& out) {
+            CharSet cs;
+            bool negate = false;
+            if (!eof() && s[i] == '^') { negate = true; ++i; }
+
+            while (!eof() && s[i] != ']') {
+                int lo;
+                char c = s[i++];
+                if (c == '\\') {
+                    if (eof()) return false;
+                    c = s[i++];
+                    CharSet esc;
+                    if (classEscape(c, esc)) { cs |= esc; continue; }
+                    lo = (c == 'b') ? '\b' : simpleEscape(c);
+                    if (lo < 0) return false;
+                }
+                else {
+                    lo = static_cast<unsigned char>(c);
+                }
+
+                // a range, unless the '-' is the last thing in the class
+                if (i + 1 < s.size() && s[i] == '-' && s[i + 1] != ']') {
+                    ++i;
+                    int hi;
+                    char d = s[i++];
+                    if (d == '\\') {
+                        if (eof()) return false;
+                        d = s[i++];
+                        hi = (d == 'b') ? '\b' : simpleEscape(d);
+                        if (hi < 0) return false;
+                    }
+                    else {
+                        hi = static_cast<unsigned char>(d);
+                    }
+                    if (hi < lo) return false;
+                    for (int x = lo; x <= hi; ++x) cs.set(x);
+                }
+                else {
+                    cs.set(lo);
+                }
+            }
+            if (eof()) return false;
+            ++i; // ']'
+
+            if (icase) cs = fold(cs);
+            if (negate) cs = ~cs;
+
+            out.op = Op::Set;
+            out.set = cs;
+            return true;
+        }
+
+        bool parseAtom(Node& out) {
+            const char c = s[i++];
+            switch (c) {
+            case '(': {
+                if (!eof() && s[i] == '?') {
+                    if (i + 1 < s.size() && s[i + 1] == ':') i += 2;
+                    else return false; // lookahead
+                }
+                if (!parseAlt(out)) return false;
+                if (eof() || s[i] != ')') return false;
+                ++i;
+                return true;
+            }
+            case '[':
+                return parseClass(out);
+            case '.': {
+                CharSet cs;
+                cs.set();
+                cs.reset('\n');
+                cs.reset('\r');
+                out.op = Op::Set;
+                out.set = cs;
+                return true;
+            }
+            case '^': out.op = Op::LineStart; return true;
+            case '$': out.op = Op::LineEnd; return true;
+            case '\\': {
+                if (eof()) return false;
+                const char e = s[i++];
+                if (e == 'b') { out.op = Op::WordBoundary; return true; }
+                if (e == 'B') { out.op = Op::NotWordBoundary; return true; }
+                CharSet cs;
+                if (classEscape(e, cs)) { out = setNode(cs); return true; }
+                const int v = simpleEscape(e);
+                if (v < 0) return false;
+                cs.set(v);
+                out = setNode(cs);
+                return true;
+            }
+            case '*': case '+': case '?': case '{': case '|': case ')':
+                return false;
+            default: {
+                CharSet cs;
+                cs.set(static_cast<unsigned char>(c));
+                out = setNode(cs);
+                return true;
+            }
+            }
+        }
+
+        bool parseNumber(int& v) {
+            const size_t from = i;
+            v = 0;
+            while (!eof() && s[i] >= '0' && s[i] <= '9') {
+                v = v * 10 + (s[i++] - '0');
+                if (v > 1000) return false;
+            }
+            return i > from;
+        }
+
+        bool parseRepeat(Node& out) {
+            Node atom;
+            if (!parseAtom(atom)) return false;
+
+            if (!eof()) {
+                int mn = -1, mx = -1;
+                const char c = s[i];
+                if (c == '*') { mn = 0; mx = -1; ++i; }
+                else if (c == '+') { mn = 1; mx = -1; ++i; }
+                else if (c == '?') { mn = 0; mx = 1; ++i; }
+                else if (c == '{') {
+                    ++i;
+                    if (!parseNumber(mn)) return false;
+                    mx = mn;
+                    if (!eof() && s[i] == ',') {
+                        ++i;
+                        mx = -1;
+                        if (!eof() && s[i] != '}' && (!parseNumber(mx) || mx < mn)) return false;
+                    }
+                    if (eof() || s[i] != '}') return false;
+                    ++i;
+                }
+
+                if (mn >= 0) {
+                    // lazy or greedy, the same lines match
+                    if (!eof() && s[i] == '?') ++i;
+                    if (atom.op != Op::Set && atom.op != Op::Cat && atom.op != Op::Alt && atom.op != Op::Repeat && atom.op != Op::Empty)
+                        return false;
+                    Node r;
+                    r.op = Op::Repeat;
+                    r.min = mn;
+                    r.max = mx;
+                    r.kids.push_back(std::move(atom));
+                    atom = std::move(r);
+                }
+            }
+
+            out = std::move(atom);
+            return true;
+        }
+
+        bool parseCat(Node& out) {
+            Node cat;
+            cat.op = Op::Cat;
+            while (!eof() && s[i] != '|' && s[i] != ')') {
+                Node n;
+                if (!parseRepeat(n)) return false;
+                cat.kids.push_back(std::move(n));
+            }
+            if (cat.kids.empty()) out = Node{};
+            else if (cat.kids.size() == 1) out = std::move(cat.kids.front());
+            else out = std::move(cat);
+            return true;
+        }
+
+        bool parseAlt(Node& out) {
+            Node first;
+            if (!parseCat(first)) return false;
+            if (eof() || s[i] != '|') {
+                out = std::move(first);
+                return true;
+            }
+
+            Node alt;
+            alt.op = Op::Alt;
+            alt.kids.push_back(std::move(first));
+            while (!eof() && s[i] == '|') {
+                ++i;
+                Node n;
+                if (!parseCat(n)) return false;
+                alt.kids.push_back(std::move(n));
+            }
+            out = std::move(alt);
+            return true;
+        }
+    };
+
+}
+
+bool Logwatch::Rx::parse(const std::string_view& src, const bool& icase, Node& out) {
+    Parser p{ src, 0, icase };
+    Node n;
+    if (!p.parseAlt(n) || !p.eof()) return false;
+    out = std::move(n);
+    return true;
+}
+
+namespace {
+
+    using Strings = std::vector<std::string>;
+
+    constexpr size_t kMaxKeywords = 64;
+    constexpr size_t kMaxKeywordLen = 32;
+
+    // What a subexpression tells us about the text it matches, with whitespace dropped
+    // and letters lowercased (the prefilter looks at lines the same way).
+    struct Lits {
+        bool    exact = false;    // it matches exactly one of strs
+        Strings strs;
+        bool    required = false; // every match contains one of req
+        Strings req;
+    };
+
+    void dedupe(Strings& s) {
+        std::sort(s.begin(), s.end());
+        s.erase(std::unique(s.begin(), s.end()), s.end());
+    }
+
+    bool cross(const Strings& a, const Strings& b, Strings& out) {
+        if (a.size() * b.size() > kMaxKeywords) return false;
+        out.clear();
+        for (const auto& x : a) {
+            for (const auto& y : b) {
+                if (x.size() + y.size() > kMaxKeywordLen) return false;
+                out.push_back(x + y);
+            }
+        }
+        dedupe(out);
+        return true;
+    }
+
+    size_t shortest(const Strings& s) {
+        size_t m = SIZE_MAX;
+        for (const auto& x : s) m = std::min(m, x.size());
+        return m;
+    }
+
+    // Keep cand as the requirement if it's better: longer shortest keyword, then fewer of them.
+    void consider(Lits& l, const Strings& cand) {
+        if (cand.empty() || cand.size() > kMaxKeywords || shortest(cand) == 0) return;
+        if (!l.required || shortest(cand) > shortest(l.req) || (shortest(cand) == shortest(l.req) && cand.size() < l.req.size())) {
+            l.required = true;
+            l.req = cand;
+        }
+    }
+
+    Lits analyze(const Node& n) {
+        Lits l;
+        switch (n.op) {
+        case Op::Set: {
+            // Big sets aren't worth listing, but only an exhaustive list may be exact:
+            // stopping early and calling the rest "exact" drops members from the keywords.
+            Strings s;
+            bool complete = true;
+            for (int c = 0; c < 256; ++c) {
+                if (!n.set[c]) continue;
+                if (s.size() > 8) {
+                    complete = false;
+                    break;
+                }
+                const auto uc = static_cast<unsigned char>(c);
+                if (Logwatch::Prefilter::isSpace(uc)) s.emplace_back();
+                else s.emplace_back(1, char(Logwatch::Prefilter::lower(uc)));
+            }
+            dedupe(s);
+            if (complete && s.size() <= 4) {
+                l.exact = true;
+                l.strs = std::move(s);
+            }
+            break;
+        }
+
+        case Op::Cat: {
+            Strings run{ "" }, next;
+            bool allExact = true;
+            for (const auto& kid : n.kids) {
+                const auto k = analyze(kid);
+                if (k.exact && cross(run, k.strs, next)) {
+                    run.swap(next);
+                    continue;
+                }
+                allExact = false;
+                consider(l, run);
+                if (k.exact) {
+                    run = k.strs;
+                }
+                else {
+                    run.assign(1, "");
+                    if (k.required) consider(l, k.req);
+                }
+            }
+            consider(l, run);
+            if (allExact) {
+                l.exact = true;
+                l.strs = std::move(run);
+            }
+            break;
+        }
+
+        case Op::Alt: {
+            Strings exact, req;
+            bool allExact = true, allReq = true;
+            for (const auto& kid : n.kids) {
+                auto k = analyze(kid);
+                if (k.exact) exact.insert(exact.end(), k.strs.begin(), k.strs.end());
+                else allExact = false;
+
+                Lits best;
+                if (k.exact) consider(best, k.strs);
+                if (k.required) consider(best, k.req);
+                if (best.required) req.insert(req.end(), best.req.begin(), best.req.end());
+                else allReq = false;
+            }
+            dedupe(exact);
+            dedupe(req);
+            if (allExact && exact.size() <= kMaxKeywords) {
+                l.exact = true;
+                l.strs = exact;
+            }
+            if (allReq) consider(l, req);
+            break;
+        }
+
+        case Op::Repeat: {
+            const auto k = analyze(n.kids.front());
+            const bool blank = k.exact && k.strs == Strings{ "" };
+
+            if (blank) {
+                // \s*, \s+, (^|\s)? ... all vanish once whitespace is dropped
+                l.exact = true;
+                l.strs = k.strs;
+            }
+            else if (n.min == 0) {
+                if (k.exact && n.max == 1) {
+                    l.exact = true;
+                    l.strs = k.strs;
+                    l.strs.emplace_back();
+                    dedupe(l.strs);
+                }
+            }
+            else {
+                if (k.exact) {
+                    consider(l, k.strs);
+                    Strings run{ "" }, next;
+                    bool ok = true;
+                    for (int i = 0; i < n.min && ok; ++i) {
+                        ok = cross(run, k.strs, next);
+                        run.swap(next);
+                    }
+                    if (ok) {
+                        consider(l, run);
+                        if (n.min == n.max) {
+                            l.exact = true;
+                            l.strs = std::move(run);
+                        }
+                    }
+                }
+                if (k.required) consider(l, k.req);
+            }
+            break;
+        }
+
+        default:
+            // Empty and the assertions match no text
+            l.exact = true;
+            l.strs.assign(1, "");
+            break;
+        }
+        return l;
+    }
+
+}
+
+bool Logwatch::Rx::keywords(const Node& n, std::vector<std::string>& out) {
+    const auto l = analyze(n);
+    Lits best;
+    if (l.exact) consider(best, l.strs);
+    if (l.required) consider(best, l.req);
+    if (!best.required) return false;
+    out = std::move(best.req);
+    return true;
+}
+
+bool Logwatch::Rx::matchesAnyLine(const Node& n) {
+    const Node* set = &n;
+    if (n.op == Op::Repeat) {
+        if (n.min > 1 || n.max != -1) return false;
+        set = &n.kids.front();
+    }
+    if (set->op != Op::Set) return false;
+
+    // everything but the line breaks, which a line never contains
+    auto cs = set->set;
+    cs.set('\n');
+    cs.set('\r');
+    return cs.all();
+}
+
+int Logwatch::Classifier::addState(const NState& s) {
+    if (nfa.size() >= kMaxNfaStates) return -1;
+    nfa.push_back(s);
+    return int(nfa.size() - 1);
+}
+
+// Builds the states for n so that matching it continues at next; returns its entry (-1 if too big).
+int Logwatch::Classifier::emit(const Rx::Node& n, int next) {
+    if (next < 0) return -1;
+
+    switch (n.op) {
+    case Rx::Op::Empty:
+        return next;
+
+    case Rx::Op::Set: {
+        NState s;
+        s.kind = NState::Kind::Set;
+        sets.push_back(n.set);
+        s.set = int(sets.size() - 1);
+        s.out = next;
+        return addState(s);
+    }
+
+    case Rx::Op::Cat:
+        for (auto it = n.kids.rbegin(); it != n.kids.rend() && next >= 0; ++it) next = emit(*it, next);
+        return next;
+
+    case Rx::Op::Alt: {
+        int entry = emit(n.kids.back(), next);
+        for (auto it = n.kids.rbegin() + 1; it != n.kids.rend() && entry >= 0; ++it) {
+            NState s;
+            s.out = emit(*it, next);
+            s.out1 = entry;
+            if (s.out < 0) return -1;
+            entry = addState(s);
+        }
+        return entry;
+    }
+
+    case Rx::Op::Repeat: {
+        const auto& kid = n.kids.front();
+        int tail = next;
+
+        if (n.max < 0) {
+            // kid* : a split that loops back through kid
+            const int loop = addState(NState{});
+            if (loop < 0) return -1;
+            const int body = emit(kid, loop);
+            if (body < 0) return -1;
+            nfa[loop].out = body;
+            nfa[loop].out1 = next;
+            tail = loop;
+        }
+        else {
+            // (kid(kid(...)?)?)? for the optional copies
+            for (int k = 0; k < n.max - n.min && tail >= 0; ++k) {
+                NState s;
+                s.out = emit(kid, tail);
+                s.out1 = next;
+                if (s.out < 0) return -1;
+                tail = addState(s);
+            }
+        }
+
+        for (int k = 0; k < n.min && tail >= 0; ++k) tail = emit(kid, tail);
+        return tail;
+    }
+
+    default: {
+        NState s;
+        s.kind = NState::Kind::Assert;
+        s.assert = n.op;
+        s.out = next;
+        return addState(s);
+    }
+    }
+}
+
+void Logwatch::Classifier::buildClasses() {
+    // Two bytes share a class when every set (and \b) agrees on them.
+    std::unordered_map<std::string, uint8_t> seen;
+    std::string sig;
+    const auto wordSet = words();
+
+    classRep.clear();
+    for (int c = 0; c < 256; ++c) {
+        sig.assign(sets.size() + 1, '0');
+        for (size_t k = 0; k < sets.size(); ++k) if (sets[k][c]) sig[k] = '1';
+        if (wordSet[c]) sig.back() = '1';
+
+        auto [it, fresh] = seen.try_emplace(sig, uint8_t(classRep.size()));
+        if (fresh) classRep.push_back(uint8_t(c));
+        byteClass[c] = it->second;
+    }
+    numClasses = classRep.size();
+}
+
+void Logwatch::Classifier::build(const std::vector<LevelPattern>& patterns) {
+    nfa.clear();
+    sets.clear();
+    starts.clear();
+    bitOf.assign(patterns.size(), -1);
+    fallback.assign(patterns.size(), std::regex{});
+    stopMask = 0;
+    keywordless = 0;
+    catchAll = -1;
+    linesSeen = 0;
+    linesPassed = 0;
+
+    std::vector<std::vector<std::string>> keywords(std::min<size_t>(patterns.size(), kMaxPatterns));
+
+    size_t compiled = 0;
+    for (size_t p = 0; p < patterns.size(); ++p) {
+        const auto& pat = patterns[p];
+
+        Rx::Node root;
+        const bool parsed = Rx::parse(pat.source, pat.icase, root);
+        bool ok = parsed && compiled < kMaxPatterns;
+
+        if (p < keywords.size()) {
+            if (!parsed || !Rx::keywords(root, keywords[p])) keywordless |= 1ull << p;
+        }
+        if (parsed && catchAll < 0 && Rx::matchesAnyLine(root)) catchAll = int(p);
+
+        if (ok) {
+            const size_t nfaBefore = nfa.size(), setsBefore = sets.size();
+            NState acc;
+            acc.kind = NState::Kind::Accept;
+            acc.pattern = int(compiled);
+            const int start = emit(root, addState(acc));
+            if (start >= 0) {
+                starts.push_back(start);
+                bitOf[p] = int(compiled++);
+            }
+            else {
+                // too big once expanded
+                nfa.resize(nfaBefore);
+                sets.resize(setsBefore);
+                ok = false;
+            }
+        }
+
+        if (!ok) {
+            fallback[p] = pat.rx;
+            logger::info("Pattern '{}' stays on std::regex", pat.name);
+        }
+    }
+
+    if (!bitOf.empty() && bitOf.front() >= 0) stopMask = 1ull << bitOf.front();
+
+    prefilter.build(keywords);
+
+    buildClasses();
+    mark.assign(nfa.size(), 0);
+    epoch = 0;
+    resetCache();
+
+    logger::info("Level classifier: {} of {} pattern(s) compiled, {} NFA states, {} byte classes",
+        compiled, patterns.size(), nfa.size(), numClasses);
+}
+
+void Logwatch::Classifier::resetCache() {
+    dstates.clear();
+    trans.clear();
+    accept.clear();
+    index.clear();
+    startState = intern({}, true, false);
+}
+
+void Logwatch::Classifier::closure(const std::vector<int>& kernel, const bool& atStart, const bool& prevWord,
+                                   const bool& atEnd, const bool& nextWord, uint64_t& acc) {
+    consumers.clear();
+    acc = 0;
+
+    if (++epoch == 0) {
+        std::fill(mark.begin(), mark.end(), 0);
+        epoch = 1;
+    }
+
+    // Unanchored search: every pattern may start at every position.
+    stack.assign(kernel.begin(), kernel.end());
+    stack.insert(stack.end(), starts.begin(), starts.end());
+
+    while (!stack.empty()) {
+        const int s = stack.back();
+        stack.pop_back();
+        if (mark[s] == epoch) continue;
+        mark[s] = epoch;
+
+        const auto& st = nfa[s];
+        switch (st.kind) {
+        case NState::Kind::Set:
+            consumers.push_back(s);
+            break;
+        case NState::Kind::Split:
+            stack.push_back(st.out);
+            if (st.out1 >= 0) stack.push_back(st.out1);
+            break;
+        case NState::Kind::Accept:
+            acc |= 1ull << st.pattern;
+            break;
+        case NState::Kind::Assert: {
+            bool pass = false;
+            switch (st.assert) {
+            case Rx::Op::LineStart:       pass = atStart; break;
+            case Rx::Op::LineEnd:         pass = atEnd; break;
+            case Rx::Op::WordBoundary:    pass = prevWord != nextWord; break;
+            case Rx::Op::NotWordBoundary: pass = prevWord == nextWord; break;
+            default: break;
+            }
+            if (pass) stack.push_back(st.out);
+            break;
+        }
+        }
+    }
+}
+
+int Logwatch::Classifier::intern(std::vector<int>&& kernel, const bool& atStart, const bool& prevWord) {
+    std::string key(reinterpret_cast<const char*>(kernel.data()), kernel.size() * sizeof(int));
+    key.push_back(char(atStart));
+    key.push_back(char(prevWord));
+
+    if (auto it = index.find(key); it != index.end()) return it->second;
+
+    DState d;
+    d.kernel = std::move(kernel);
+    d.atStart = atStart;
+    d.prevWord = prevWord;
+    dstates.push_back(std::move(d));
+    trans.resize(dstates.size() * numClasses, -1);
+    accept.resize(dstates.size() * numClasses, 0);
+
+    const int id = int(dstates.size() - 1);
+    index.emplace(std::move(key), id);
+    return id;
+}
+
+// Builds the transition of s on a byte of class cls.
+int Logwatch::Classifier::step(int s, const uint8_t& cls, uint64_t& acc) {
+    const auto rep = classRep[cls];
+    const bool nextWord = Rx::isWord(rep);
+
+    {
+        const auto& d = dstates[s];
+        closure(d.kernel, d.atStart, d.prevWord, false, nextWord, acc);
+    }
+
+    std::vector<int> kernel;
+    kernel.reserve(consumers.size());
+    for (const int c : consumers) {
+        if (sets[nfa[c].set][rep]) kernel.push_back(nfa[c].out);
+    }
+    std::sort(kernel.begin(), kernel.end());
+    kernel.erase(std::unique(kernel.begin(), kernel.end()), kernel.end());
+
+    if (dstates.size() >= kMaxDfaStates) {
+        // Pathological input or patterns: start over rather than grow without bound.
+        ++flushes;
+        resetCache();
+        return intern(std::move(kernel), false, nextWord);
+    }
+
+    const int t = intern(std::move(kernel), false, nextWord);
+    trans[size_t(s) * numClasses + cls] = t;
+    accept[size_t(s) * numClasses + cls] = acc;
+    return t;
+}
+
+uint64_t Logwatch::Classifier::acceptAtEnd(const int& s) {
+    auto& d = dstates[s];
+    if (!d.endKnown) {
+        uint64_t acc = 0;
+        closure(d.kernel, d.atStart, d.prevWord, true, false, acc);
+        dstates[s].endAccept = acc;
+        dstates[s].endKnown = true;
+    }
+    return dstates[s].endAccept;
+}
+
+int Logwatch::Classifier::classify(const std::string_view& line) {
+
+    ++linesSeen;
+
+    if (!prefilter.empty()) {
+        // Walk the patterns in priority order, skipping those whose keywords aren't there.
+        const uint64_t candidates = prefilter.scan(line) | keywordless;
+        size_t p = 0;
+        for (; p < bitOf.size() && p < kMaxPatterns; ++p) {
+            if (!(candidates & (1ull << p))) continue;
+            if (int(p) == catchAll && !line.empty()) return catchAll;
+            break;
+        }
+        if (p == bitOf.size()) return -1;
+    }
+
+    ++linesPassed;
+
+    uint64_t hit = 0;
+
+    if (!starts.empty()) {
+        int s = startState;
+        for (const char ch : line) {
+            const uint8_t cls = byteClass[static_cast<unsigned char>(ch)];
+            const size_t at = size_t(s) * numClasses + cls;
+
+            uint64_t acc;
+            int t = trans[at];
+            if (t >= 0) acc = accept[at];
+            else t = step(s, cls, acc);
+
+            hit |= acc;
+            s = t;
+            if (hit & stopMask) break;
+        }
+        if (!(hit & stopMask)) hit |= acceptAtEnd(s);
+    }
+
+    for (size_t p = 0; p < bitOf.size(); ++p) {
+        if (bitOf[p] >= 0) {
+            if (hit & (1ull << bitOf[p])) return int(p);
+        }
+        else if (std::regex_search(line.begin(), line.end(), fallback[p])) {
+            return int(p);
+        }
+    }
+    return -1;
+}
+
+size_t Logwatch::Classifier::crossCheck(const std::vector<LevelPattern>& patterns, const size_t& lines,
+                                        const uint32_t& seed, const std::vector<std::string>& extra,
+                                        const std::stop_token& stop) {
+    Classifier c;
+    c.build(patterns);
+
+    static const std::vector<std::string> fragments = {
+        "error", "ERROR", "Error", "err", "e", "critical", "CRIT", "crit", "warn", "WARNING", "warning",
+        "fail", "failed", "Failure", "failing", "terror", "errors", "info", "x", "_", "1", "0x1F",
+        "[", "]", "(", ")", ":", ",", ";", "|", ".", "-", " ", " ", " ", "\t"
+    };
+
+    std::mt19937 rng(seed);
+    const auto pick = [&](const size_t& n) { return size_t(rng() % n); };
+
+    size_t mismatches = 0;
+    std::string line;
+    for (size_t i = 0; i < lines && !stop.stop_requested(); ++i) {
+        line.clear();
+        const size_t tokens = pick(12);
+        for (size_t t = 0; t < tokens; ++t) {
+            const size_t r = pick(16);
+            if (r == 0) line += char(32 + pick(95));                 // any printable
+            else if (r <= 4 && !extra.empty()) line += extra[pick(extra.size())];
+            else line += fragments[pick(fragments.size())];
+        }
+
+        int expected = -1;
+        for (size_t p = 0; p < patterns.size(); ++p) {
+            if (std::regex_search(line, patterns[p].rx)) {
+                expected = int(p);
+                break;
+            }
+        }
+
+        const int got = c.classify(line);
+        if (got != expected && ++mismatches <= 5) {
+            logger::error("Classifier disagrees with std::regex on \"{}\": {} vs {}", line, got, expected);
+        }
+    }
+    return mismatches;
+}
+
+bool Logwatch::Classifier::selfTest(const std::stop_token& stop) {
+    constexpr size_t kLines = 600000;
+
+    const Config defaults;
+    size_t bad = crossCheck(defaults.patterns, kLines, 1, {}, stop);
+
+    // Sets with more than nine members (whitespace counts six), which the keyword
+    // analysis used to cut short; the extras make lines like "er|ror" common enough.
+    std::vector<LevelPattern> sets;
+    sets.emplace_back("error", R"(er[\s,;:|]ror)", true);
+    sets.emplace_back("warning", R"(wa[\s.,;:!?|#-]+rn)", true);
+    sets.emplace_back("fail", R"(fa[a-z]l|[^x]ail)", false);
+    sets.emplace_back("other", R"(.+)", false);
+    bad += crossCheck(sets, kLines / 10, 2, { "er", "ror", "wa", "rn", "fa", "ail", "|", "!", "?", "#" }, stop);
+
+    if (stop.stop_requested()) logger::info("Classifier self test stopped early, {} mismatch(es) so far", bad);
+    else if (bad) logger::error("Classifier self test: {} line(s) disagree with std::regex", bad);
+    else logger::info("Classifier self test: {} line(s) agree with std::regex", kLines + kLines / 10);
+    return bad == 0 && !stop.stop_requested();
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+
+#include "discovery.hpp"
+#include "filestatus.hpp"
+#include "logger.hpp"
+#include "utils.hpp"
+
+namespace {
+
+    // Anything touched more recently than this may still change within the same
+    // timestamp tick (FAT has 2 s granularity), so we don't trust it yet.
+    constexpr auto RACY_WINDOW = std::chrono::seconds(2);
+
+}
+
+Logwatch::DirCache::Dir& Logwatch::DirCache::refresh(const fs::path& dir, const Filter& include) {
+
+    const auto st = FileStatus::query(dir);
+    const auto mtime = st.writeTime;
+
+    auto [it, fresh] = dirs.try_emplace(dir.native());
+    Dir& d = it->second;
+
+    if (!fresh && st.exists && d.settled && mtime == d.mtime) return d;
+
+    // Keep what we already know about the files that are still there.
+    std::unordered_map<fs::path::string_type, Entry> known;
+    known.reserve(d.files.size());
+    for (auto& e : d.files) {
+        auto name = e.path.filename().native();
+        known.emplace(std::move(name), std::move(e));
+    }
+
+    std::vector<Entry> files;
+    std::vector<fs::path> subdirs;
+    files.reserve(d.files.size());
+
+    std::error_code itec;
+    auto dit = fs::directory_iterator(dir, fs::directory_options::skip_permission_denied, itec);
+    for (fs::directory_iterator end; !itec && dit != end; dit.increment(itec)) {
+
+        const auto& p = dit->path();
+        std::error_code eec;
+
+        // Same rules as recursive_directory_iterator: don't follow directory symlinks.
+        if (dit->is_directory(eec)) {
+            if (!dit->is_symlink(eec)) subdirs.push_back(p);
+            continue;
+        }
+
+        if (!dit->is_regular_file(eec)) continue;
+
+        if (auto k = known.find(p.filename().native()); k != known.end()) {
+            files.push_back(std::move(k->second));
+            continue;
+        }
+
+        Entry e;
+        e.path = p;
+        e.included = include(p);
+        if (e.included) e.canon = Utils::toUTF8(fs::weakly_canonical(p, eec));
+        files.push_back(std::move(e));
+    }
+
+    if (itec) {
+        const std::string dirToPrint = Utils::replaceUsername(Utils::toUTF8(dir));
+        logger::info("discoverFiles: cannot iterate over {}: {}", dirToPrint, itec.message());
+    }
+
+    d.files = std::move(files);
+    d.subdirs = std::move(subdirs);
+    d.mtime = mtime;
+    d.settled = st.exists && !itec && (fs::file_time_type::clock::now() - mtime) > RACY_WINDOW;
+    return d;
+}
+
+void Logwatch::DirCache::collect(const fs::path& root, const Filter& include, std::vector<DiscoveredFile>& out, const std::stop_token& stop) {
+
+    std::error_code ec;
+    if (!fs::exists(root, ec) || !fs::is_directory(root, ec)) return;
+
+    std::vector<fs::path> pendingDirs{ root };
+
+    while (!pendingDirs.empty()) {
+
+        if (stop.stop_requested()) return;
+
+        const fs::path dir = std::move(pendingDirs.back());
+        pendingDirs.pop_back();
+
+        Dir& d = refresh(dir, include);
+        d.seen = generation;
+
+        for (const auto& e : d.files) {
+            if (e.included) out.push_back({ e.path, e.canon });
+        }
+
+        pendingDirs.insert(pendingDirs.end(), d.subdirs.rbegin(), d.subdirs.rend());
+    }
+}
+
+void Logwatch::DirCache::sweep() {
+    std::erase_if(dirs, [this](const auto& kv) { return kv.second.seen != generation; });
+}
@@ -0,0 +1,41 @@
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#include <chrono>
+#endif
+
+#include "filestatus.hpp"
+
+Logwatch::FileStatus Logwatch::FileStatus::query(const fs::path& p) {
+
+    counter.fetch_add(1, std::memory_order_relaxed);
+
+    FileStatus st;
+
+#if defined(_WIN32)
+    // Same call std::filesystem makes for file_size/last_write_time, just once.
+    WIN32_FILE_ATTRIBUTE_DATA data{};
+    if (!GetFileAttributesExW(p.c_str(), GetFileExInfoStandard, &data)) return st;
+
+    st.exists = true;
+    st.size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+
+    // MSVC's file_clock is FILETIME (100 ns ticks since 1601), so this is lossless.
+    const auto ticks = (int64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    st.writeTime = fs::file_time_type{ fs::file_time_type::duration{ ticks } };
+#else
+    struct stat sb {};
+    if (::stat(p.c_str(), &sb) != 0) return st;
+
+    st.exists = true;
+    st.size = uint64_t(sb.st_size);
+    st.id = { uint64_t(sb.st_dev), uint64_t(sb.st_ino) };
+
+    const auto since = std::chrono::seconds(sb.st_mtim.tv_sec) + std::chrono::nanoseconds(sb.st_mtim.tv_nsec);
+    const auto sys = std::chrono::sys_time<std::chrono::nanoseconds>(since);
+    st.writeTime = std::chrono::time_point_cast<fs::file_time_type::duration>(std::chrono::file_clock::from_sys(sys));
+#endif
+
+    return st;
+}
@@ -0,0 +1,272 @@
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#include <new>
+#include <utility>
+#include <algorithm>
+
+#include "handles.hpp"
+
+#if defined(_WIN32)
+
+namespace {
+
+    bool HandleName(HANDLE h, std::wstring& out) {
+        // FILE_NAME_INFO followed by room for a long path.
+        alignas(FILE_NAME_INFO) char buf[sizeof(FILE_NAME_INFO) + 2048 * sizeof(WCHAR)];
+        auto* info = reinterpret_cast<FILE_NAME_INFO*>(buf);
+        if (!GetFileInformationByHandleEx(h, FileNameInfo, info, sizeof(buf))) return false;
+        out.assign(info->FileName, info->FileNameLength / sizeof(WCHAR));
+        return true;
+    }
+
+}
+
+void Logwatch::ReadHandle::close() noexcept {
+    if (h && h != INVALID_HANDLE_VALUE) CloseHandle(h);
+    h = nullptr;
+    openedAs.clear();
+    fid = {};
+}
+
+Logwatch::ReadHandle& Logwatch::ReadHandle::operator=(ReadHandle&& o) noexcept {
+    if (this != &o) {
+        close();
+        h = std::exchange(o.h, nullptr);
+        openedAs = std::move(o.openedAs);
+        fid = std::exchange(o.fid, {});
+    }
+    return *this;
+}
+
+Logwatch::ReadHandle Logwatch::ReadHandle::open(const fs::path& p) {
+    ReadHandle rh;
+    HANDLE f = CreateFileW(p.c_str(), GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return rh;
+
+    rh.h = f;
+
+    BY_HANDLE_FILE_INFORMATION info{};
+    if (GetFileInformationByHandle(f, &info)) {
+        rh.fid.volume = info.dwVolumeSerialNumber;
+        rh.fid.index = (uint64_t(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+    }
+    HandleName(f, rh.openedAs);
+    return rh;
+}
+
+bool Logwatch::ReadHandle::valid() const noexcept { return h && h != INVALID_HANDLE_VALUE; }
+
+bool Logwatch::ReadHandle::detached() const {
+    FILE_STANDARD_INFO st{};
+    if (GetFileInformationByHandleEx(h, FileStandardInfo, &st, sizeof(st)) && st.DeletePending) return true;
+
+    // Rotation renames the old log away, and the handle follows it.
+    std::wstring now;
+    if (openedAs.empty() || !HandleName(h, now)) return false;
+    return now != openedAs;
+}
+
+size_t Logwatch::ReadHandle::readAt(const uint64_t& offset, char* dst, const size_t& n) const {
+    size_t total = 0;
+    while (total < n) {
+        OVERLAPPED ov{};
+        const uint64_t at = offset + total;
+        ov.Offset = DWORD(at & 0xFFFFFFFFull);
+        ov.OffsetHigh = DWORD(at >> 32);
+        const DWORD want = DWORD(std::min<size_t>(n - total, 1u << 30));
+        DWORD got = 0;
+        if (!ReadFile(h, dst + total, want, &got, &ov) || got == 0) break;
+        total += got;
+    }
+    return total;
+}
+
+Logwatch::MappedView Logwatch::ReadHandle::map(const uint64_t& offset, const size_t& n) const {
+    MappedView view;
+    if (!n) return view;
+
+    static const uint64_t granularity = [] {
+        SYSTEM_INFO si{};
+        GetSystemInfo(&si);
+        return uint64_t(si.dwAllocationGranularity);
+    }();
+
+    // Views must start on the allocation granularity (64 KB), so map a little in front.
+    const uint64_t start = offset - (offset % granularity);
+    const size_t   span = size_t(offset - start) + n;
+
+    HANDLE section = CreateFileMappingW(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!section) return view;
+
+    void* base = MapViewOfFile(section, FILE_MAP_READ, DWORD(start >> 32), DWORD(start & 0xFFFFFFFFull), span);
+
+    // The view keeps the section alive.
+    CloseHandle(section);
+    if (!base) return view;
+
+    view.base = base;
+    view.baseLen = span;
+    view.ptr = static_cast<const char*>(base) + (offset - start);
+    view.len = n;
+    return view;
+}
+
+void Logwatch::MappedView::unmap() noexcept {
+    if (base) UnmapViewOfFile(base);
+    base = nullptr;
+    baseLen = 0;
+    ptr = nullptr;
+    len = 0;
+}
+
+#else
+
+void Logwatch::ReadHandle::close() noexcept {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    fid = {};
+}
+
+Logwatch::ReadHandle& Logwatch::ReadHandle::operator=(ReadHandle&& o) noexcept {
+    if (this != &o) {
+        close();
+        fd = std::exchange(o.fd, -1);
+        fid = std::exchange(o.fid, {});
+    }
+    return *this;
+}
+
+Logwatch::ReadHandle Logwatch::ReadHandle::open(const fs::path& p) {
+    ReadHandle rh;
+    rh.fd = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+    if (rh.fd < 0) return rh;
+
+    struct stat sb {};
+    if (::fstat(rh.fd, &sb) == 0) {
+        rh.fid.volume = uint64_t(sb.st_dev);
+        rh.fid.index = uint64_t(sb.st_ino);
+    }
+    return rh;
+}
+
+bool Logwatch::ReadHandle::valid() const noexcept { return fd >= 0; }
+
+bool Logwatch::ReadHandle::detached() const {
+    // Renames are caught by the identity check in acquire; here we only see unlinks.
+    struct stat sb {};
+    return ::fstat(fd, &sb) != 0 || sb.st_nlink == 0;
+}
+
+size_t Logwatch::ReadHandle::readAt(const uint64_t& offset, char* dst, const size_t& n) const {
+    size_t total = 0;
+    while (total < n) {
+        const ssize_t got = ::pread(fd, dst + total, n - total, off_t(offset + total));
+        if (got <= 0) break;
+        total += size_t(got);
+    }
+    return total;
+}
+
+Logwatch::MappedView Logwatch::ReadHandle::map(const uint64_t& offset, const size_t& n) const {
+    MappedView view;
+    if (!n) return view;
+
+    // Don't map past the end, touching those pages would be a SIGBUS.
+    struct stat sb {};
+    if (::fstat(fd, &sb) != 0 || uint64_t(sb.st_size) < offset + n) return view;
+
+    static const uint64_t page = uint64_t(::sysconf(_SC_PAGESIZE));
+
+    const uint64_t start = offset - (offset % page);
+    const size_t   span = size_t(offset - start) + n;
+
+    void* base = ::mmap(nullptr, span, PROT_READ, MAP_PRIVATE, fd, off_t(start));
+    if (base == MAP_FAILED) return view;
+
+    view.base = base;
+    view.baseLen = span;
+    view.ptr = static_cast<const char*>(base) + (offset - start);
+    view.len = n;
+    return view;
+}
+
+void Logwatch::MappedView::unmap() noexcept {
+    if (base) ::munmap(base, baseLen);
+    base = nullptr;
+    baseLen = 0;
+    ptr = nullptr;
+    len = 0;
+}
+
+#endif
+
+Logwatch::MappedView& Logwatch::MappedView::operator=(MappedView&& o) noexcept {
+    if (this != &o) {
+        unmap();
+        base = std::exchange(o.base, nullptr);
+        baseLen = std::exchange(o.baseLen, 0);
+        ptr = std::exchange(o.ptr, nullptr);
+        len = std::exchange(o.len, 0);
+    }
+    return *this;
+}
+
+void Logwatch::ChunkBuffer::AlignedFree::operator()(char* p) const noexcept {
+    ::operator delete[](p, std::align_val_t{ kAlignment });
+}
+
+char* Logwatch::ChunkBuffer::reserve(const size_t& n) {
+    if (n > cap) {
+        // Round up to whole pages; grow geometrically so a slowly rising boost cap doesn't realloc every poll.
+        const size_t want = std::max(n, cap + cap / 2);
+        const size_t rounded = (want + kAlignment - 1) & ~(kAlignment - 1);
+        mem.reset(static_cast<char*>(::operator new[](rounded, std::align_val_t{ kAlignment })));
+        cap = rounded;
+    }
+    return mem.get();
+}
+
+Logwatch::ReadHandle* Logwatch::HandlePool::acquire(const std::string& key, const fs::path& p, const FileId& expected) {
+
+    if (auto it = index.find(key); it != index.end()) {
+        auto slot = it->second;
+        const bool moved = (expected.known() && expected != slot->handle.id()) || slot->handle.detached();
+        if (!moved) {
+            lru.splice(lru.begin(), lru, slot);
+            ++reuses;
+            return &slot->handle;
+        }
+        lru.erase(slot);
+        index.erase(it);
+    }
+
+    auto handle = ReadHandle::open(p);
+    if (!handle.valid()) return nullptr;
+    ++opens;
+
+    lru.push_front(Slot{ key, std::move(handle) });
+    index[key] = lru.begin();
+
+    while (lru.size() > cap) {
+        index.erase(lru.back().key);
+        lru.pop_back();
+    }
+
+    return &lru.front().handle;
+}
+
+void Logwatch::HandlePool::release(const std::string& key) {
+    if (auto it = index.find(key); it != index.end()) {
+        lru.erase(it->second);
+        index.erase(it);
+    }
+}
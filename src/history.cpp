@@ -0,0 +1,46 @@
+#include <cstring>
+#include <algorithm>
+
+#include "history.hpp"
+#include "utils.hpp"
+
+Logwatch::TextArena::Span Logwatch::TextArena::append(const std::string_view& s) {
+    const auto n = static_cast<uint32_t>(s.size());
+
+    if (slabs.empty() || slabs.back().size - slabs.back().used < n) {
+        // Lines are capped well below kMaxSlab, but a big one still gets a slab of its own.
+        Slab slab;
+        slab.size = std::max(nextSize, n);
+        slab.data = std::make_unique<char[]>(slab.size);
+        allocated += slab.size;
+        nextSize = std::min(nextSize * 2, kMaxSlab);
+        slabs.push_back(std::move(slab));
+    }
+
+    auto& tail = slabs.back();
+    Span sp{ firstSlab + uint32_t(slabs.size() - 1), tail.used, n };
+    if (n) std::memcpy(tail.data.get() + tail.used, s.data(), n);
+    tail.used += n;
+    return sp;
+}
+
+void Logwatch::TextArena::releaseBefore(const uint32_t& slab) {
+    while (!slabs.empty() && firstSlab < slab) {
+        allocated -= slabs.front().size;
+        slabs.pop_front();
+        ++firstSlab;
+    }
+}
+
+std::string_view Logwatch::ModHistory::display(Entry& e) {
+    if (!e.normalized) {
+        const auto clean = Utils::nukeLogLine(std::string(text.view(e.text)));
+        // It only ever removes or collapses, but better raw text than a broken arena.
+        if (clean.size() <= e.text.length) {
+            std::memcpy(text.data(e.text), clean.data(), clean.size());
+            e.text.length = static_cast<uint32_t>(clean.size());
+        }
+        e.normalized = true;
+    }
+    return text.view(e.text);
+}
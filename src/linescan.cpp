@@ -0,0 +1,123 @@
+#include <bit>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define LINESCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#include "linescan.hpp"
+
+// MSVC lets us use any intrinsic anywhere; gcc/clang want the function tagged.
+#if defined(LINESCAN_X86) && !defined(_MSC_VER)
+#define LINESCAN_AVX2 __attribute__((target("avx2")))
+#else
+#define LINESCAN_AVX2
+#endif
+
+namespace {
+
+    using Scanner = void(*)(const char*, size_t, std::vector<size_t>&);
+
+    // Also finishes the bytes the vector loops leave over.
+    inline void scanFrom(const char* p, size_t i, size_t n, std::vector<size_t>& out) {
+        for (; i < n; ++i) {
+            if (p[i] == '\n' || p[i] == '\r') out.push_back(i);
+        }
+    }
+
+    void scanScalar(const char* p, size_t n, std::vector<size_t>& out) {
+        scanFrom(p, 0, n, out);
+    }
+
+#if defined(LINESCAN_X86)
+
+    // Every set bit of mask is a break at base + bit.
+    inline void emitMask(uint32_t mask, size_t base, std::vector<size_t>& out) {
+        while (mask) {
+            out.push_back(base + size_t(std::countr_zero(mask)));
+            mask &= mask - 1;
+        }
+    }
+
+    void scanSSE2(const char* p, size_t n, std::vector<size_t>& out) {
+        const __m128i lf = _mm_set1_epi8('\n');
+        const __m128i cr = _mm_set1_epi8('\r');
+
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            const __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr));
+            emitMask(uint32_t(_mm_movemask_epi8(hit)), i, out);
+        }
+
+        scanFrom(p, i, n, out);
+    }
+
+    LINESCAN_AVX2 void scanAVX2(const char* p, size_t n, std::vector<size_t>& out) {
+        const __m256i lf = _mm256_set1_epi8('\n');
+        const __m256i cr = _mm256_set1_epi8('\r');
+
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            const __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr));
+            emitMask(uint32_t(_mm256_movemask_epi8(hit)), i, out);
+        }
+
+        scanFrom(p, i, n, out);
+    }
+
+    bool hasAVX2() {
+#if defined(_MSC_VER)
+        int regs[4]{};
+        __cpuid(regs, 0);
+        if (regs[0] < 7) return false;
+
+        // The OS has to save the ymm registers too (OSXSAVE + XCR0 bits 1 and 2).
+        __cpuid(regs, 1);
+        const bool osxsave = (regs[2] & (1 << 27)) != 0;
+        const bool avx = (regs[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+#endif
+
+    struct Picked {
+        Scanner     scan;
+        const char* name;
+    };
+
+    const Picked& picked() {
+        static const Picked p = [] {
+#if defined(LINESCAN_X86)
+            if (hasAVX2()) return Picked{ scanAVX2, "avx2" };
+            // SSE2 is baseline on x64, and scanScalar stays around for everything else.
+            (void)scanScalar;
+            return Picked{ scanSSE2, "sse2" };
+#else
+            return Picked{ scanScalar, "scalar" };
+#endif
+        }();
+        return p;
+    }
+
+}
+
+void Logwatch::LineScan::findBreaks(const std::string_view& chunk, std::vector<size_t>& out) {
+    picked().scan(chunk.data(), chunk.size(), out);
+}
+
+const char* Logwatch::LineScan::implementation() {
+    return picked().name;
+}
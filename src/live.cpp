@@ -10,22 +10,42 @@
 #include "settings.hpp"
 #include "restart.hpp"
 #include "loading.hpp"
+#include "symbols.hpp"
 
-void Live::takeSnapshot(std::vector<TableRow>& rows) {
-	const auto snapMods = Logwatch::aggr.snapshot(); 
-	const auto snapPins = Logwatch::aggr.snapshotPins();
-	rows.reserve(snapMods.size());
-	for (auto& [modKey, s] : snapMods) {
-		TableRow r;
-		r.mod = modKey;
+bool Live::takeSnapshot(TableCache& cache) {
+	const auto changes = Logwatch::aggr.changedSince(cache.version);
+	const auto pins = Logwatch::aggr.pinsVersion();
+	if (!changes.any() && pins == cache.pinsVersion) return false;
+
+	auto& rows = cache.rows;
+	if (changes.full) {
+		rows.clear();
+		cache.index.clear();
+	}
+
+	for (const auto& s : changes.changed) {
+		auto [it, added] = cache.index.try_emplace(s.modId, int(rows.size()));
+		if (added) {
+			TableRow r;
+			r.modId = s.modId;
+			r.mod = Logwatch::symbols.name(s.modId);
+			rows.push_back(std::move(r));
+		}
+		auto& r = rows[it->second];
 		r.errors = s.errors;
 		r.warnings = s.warnings;
 		r.fails = s.fails;
 		r.others = s.others;
-		r.recent = (int)s.last.size();
-		r.pinned = snapPins.count(modKey) != 0;
-		rows.push_back(std::move(r));
+		r.recent = (int)s.cached;
 	}
+
+	// Pins live apart from the counts; redo the flags when they (or the rows) changed.
+	const auto snapPins = Logwatch::aggr.snapshotPins();
+	for (auto& r : rows) r.pinned = snapPins.count(r.mod) != 0;
+
+	cache.version = changes.version;
+	cache.pinsVersion = pins;
+	return true;
 }
 
 void Live::LogWatcherUI::RenderWatch() {
@@ -55,19 +75,31 @@ void Live::LogWatcherUI::RenderWatch() {
 	// controls
 	addTableControls(ps);
 
-	// get aggregator snapshot
-	std::vector<TableRow> rows;
-	takeSnapshot(rows);
-	
-	// new view
-	std::vector<int> view;
-	view.reserve(rows.size());
+	// get aggregator changes
+	auto& cache = GetTableCache();
+	const bool changed = takeSnapshot(cache);
+	auto& rows = cache.rows;
+	auto& view = cache.view;
+
+	// new view, only when something it depends on moved
+	if (changed || cache.filterText != ps.filter.InputBuf || cache.sortColumn != ps.sortColumn ||
+		cache.sortAsc != ps.sortAsc || cache.pinFirst != ps.pinFirst || cache.showPinnedOnly != ps.showPinnedOnly) {
 
-	// filter view
-	filterTable(ps, view, rows);
+		view.clear();
+		view.reserve(rows.size());
 
-	// sort view
-	sortTable(ps, view, rows);
+		// filter view
+		filterTable(ps, view, rows);
+
+		// sort view
+		sortTable(ps, view, rows);
+
+		cache.filterText = ps.filter.InputBuf;
+		cache.sortColumn = ps.sortColumn;
+		cache.sortAsc = ps.sortAsc;
+		cache.pinFirst = ps.pinFirst;
+		cache.showPinnedOnly = ps.showPinnedOnly;
+	}
 
 	// guard selection against filter
 	if (ps.selected < 0 || ps.selected >= (int)view.size()) 
@@ -184,17 +216,16 @@ void Live::LogWatcherUI::RenderDetailsWindow() {
 	ImGui::Dummy(ImVec2(0, 5));
 
 	// Snapshot summary + recent cached
-	const auto snap = Logwatch::aggr.snapshot();
-	const auto it = snap.find(modName);
-	if (it == snap.end()) {
+	const auto summary = Logwatch::aggr.summary(modName);
+	if (!summary) {
 		ImGui::TextDisabled(Trans::Tr("Watch.Details.NoData").c_str());
 		ImGui::End();
 		if (pushedWinBg) ImGui::PopStyleColor();
 		return;
 	}
 
-	const auto& modstats = it->second;
-	const int recentCached = int(modstats.last.size());
+	const auto& modstats = *summary;
+	const int recentCached = int(modstats.cached);
 	const auto cap = Logwatch::aggr.capacity();
 
 	sliderAndAll(ds, recentCached);
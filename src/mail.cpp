@@ -1,12 +1,17 @@
 
 #include "watcher.hpp"
+#include "aggregator.hpp"
 #include "settings.hpp"
 #include "translate.hpp"
 
-void Logwatch::LogWatcher::updatePeriodicBase(const Snapshot& snap, const Clock::time_point& now, const int& interval) {
-    periodicLastPerMod.clear();
-    periodicLastTotals = {};
-    for (const auto& [modKey, s] : snap) {
+void Logwatch::LogWatcher::updatePeriodicBase(const Changes& ch, const Clock::time_point& now, const int& interval) {
+    if (ch.full) {
+        periodicLastPerMod.clear();
+        periodicLastTotals = {};
+    }
+    // Only rows that moved; totals take the difference (counts only go down on a reset,
+    // and that comes in as full).
+    for (const auto& s : ch.changed) {
 
         // TODO: again = operator
         Counts c;
@@ -15,16 +20,18 @@ void Logwatch::LogWatcher::updatePeriodicBase(const Snapshot& snap, const Clock:
         c.fails = s.fails;
         c.others = s.others;
 
-        periodicLastPerMod[modKey] = c;
-        periodicLastTotals.errors += c.errors;
-        periodicLastTotals.warnings += c.warnings;
-        periodicLastTotals.fails += c.fails;
-        periodicLastTotals.others += c.others;
+        auto& prev = periodicLastPerMod[s.modId];
+        periodicLastTotals.errors += c.errors - prev.errors;
+        periodicLastTotals.warnings += c.warnings - prev.warnings;
+        periodicLastTotals.fails += c.fails - prev.fails;
+        periodicLastTotals.others += c.others - prev.others;
+        prev = c;
     }
+    periodicBaseVersion = ch.version;
     periodicNextAt = now + std::chrono::seconds(interval);
 }
 
-void Logwatch::LogWatcher::mayNorifyPeriodicAlerts(const Snapshot& snap) {
+void Logwatch::LogWatcher::mayNorifyPeriodicAlerts() {
 
     auto& st = Logwatch::GetSettings();
 
@@ -40,20 +47,22 @@ void Logwatch::LogWatcher::mayNorifyPeriodicAlerts(const Snapshot& snap) {
 
     // Compute initial base
     if (!periodicReady) {
-        updatePeriodicBase(snap, now, intervalSec);
+        updatePeriodicBase(aggr.changedSince(0), now, intervalSec);
         periodicReady = true;
         return;
     }
 
     if (now < periodicNextAt) return;
 
-    // Compute diff since last time
+    // Compute diff since last time; mods that didn't change have nothing to report.
+    const auto changes = aggr.changedSince(periodicBaseVersion);
+
     std::vector<EntryDiff> modDiffs;
-    modDiffs.reserve(snap.size());
+    modDiffs.reserve(changes.changed.size());
 
     Counts totalCounts{};
 
-    for (const auto& [modKey, s] : snap) {
+    for (const auto& s : changes.changed) {
 
         Counts curr;
         curr.errors = s.errors;
@@ -62,7 +71,7 @@ void Logwatch::LogWatcher::mayNorifyPeriodicAlerts(const Snapshot& snap) {
         curr.others = s.others;
 
         Counts prev{};
-        if (auto it = periodicLastPerMod.find(modKey); it != periodicLastPerMod.end())
+        if (auto it = periodicLastPerMod.find(s.modId); it != periodicLastPerMod.end())
             prev = it->second;
 
         Counts d;
@@ -73,7 +82,7 @@ void Logwatch::LogWatcher::mayNorifyPeriodicAlerts(const Snapshot& snap) {
         if (!levelcount) continue; // nothing to notify
 
         EntryDiff e;
-        e.mod = modKey;
+        e.mod = symbols.name(s.modId);
         e.counts = d;
         e.levelCount = levelcount;
         modDiffs.push_back(std::move(e));
@@ -85,7 +94,7 @@ void Logwatch::LogWatcher::mayNorifyPeriodicAlerts(const Snapshot& snap) {
     }
 
     // Update base
-    updatePeriodicBase(snap, now, intervalSec);
+    updatePeriodicBase(changes, now, intervalSec);
 
     if (modDiffs.empty()) return;
 
@@ -5,7 +5,7 @@
 #include "notification.hpp"
 #include "translate.hpp"
 
-void Logwatch::LogWatcher::mayNotifyPinnedAlerts(const Snapshot& snap)
+void Logwatch::LogWatcher::mayNotifyPinnedAlerts()
 {
     const auto& st = Logwatch::GetSettings();
 
@@ -19,8 +19,17 @@ void Logwatch::LogWatcher::mayNotifyPinnedAlerts(const Snapshot& snap)
     const int minIssues = (st.pinnedMinNewIssues > 0) ? st.pinnedMinNewIssues : 1;
     const int cooldownSec = (st.pinnedAlertCooldownSec > 0) ? st.pinnedAlertCooldownSec : 60;
 
-    for (const auto& [modKey, s] : snap) {
+    // Only mods that changed can have new issues, unless the pins did (a freshly pinned
+    // mod is compared against nothing, like before).
+    const auto pins = Logwatch::aggr.pinsVersion();
+    const auto ch = Logwatch::aggr.changedSince(pinnedVersion);
+    const auto& rows = (pins != pinnedPinsVersion) ? *ch.all : ch.changed;
+    pinnedVersion = ch.version;
+    pinnedPinsVersion = pins;
 
+    for (const auto& s : rows) {
+
+        const auto& modKey = symbols.name(s.modId);
         if (!Logwatch::aggr.isPinned(modKey))
             continue;
 
@@ -31,7 +40,7 @@ void Logwatch::LogWatcher::mayNotifyPinnedAlerts(const Snapshot& snap)
         curr.fails = s.fails;
         curr.others = s.others;
 
-        auto it = pinnedState.find(modKey);
+        auto it = pinnedState.find(s.modId);
         Counts prev{};
         Clock::time_point lastAt{};
         if (it != pinnedState.end()) {
@@ -44,14 +53,14 @@ void Logwatch::LogWatcher::mayNotifyPinnedAlerts(const Snapshot& snap)
 
         const uint64_t levelcount = levelCount(d, minLevel);
         if (levelcount < uint64_t(minIssues)) {
-            updatePinnedBase(modKey, curr, now);
+            updatePinnedBase(s.modId, curr, now);
             continue;
         }
 
         if (it != pinnedState.end()) {
             const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - lastAt).count();
             if (elapsed < cooldownSec) {
-                updatePinnedBase(modKey, curr, now);
+                updatePinnedBase(s.modId, curr, now);
                 continue;
             }
         }
@@ -112,6 +121,6 @@ void Logwatch::LogWatcher::mayNotifyPinnedAlerts(const Snapshot& snap)
         scheduleNotification(std::move(hud));
         scheduleMail(std::move(entry));
 
-        updatePinnedBase(modKey, curr, now);
+        updatePinnedBase(s.modId, curr, now);
     }
 }
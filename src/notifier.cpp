@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+
+#include "notifier.hpp"
+#include "logger.hpp"
+#include "utils.hpp"
+
+namespace {
+
+    // Past this many queued paths a full scan is cheaper than replaying them.
+    constexpr size_t kMaxPending = 4096;
+
+}
+
+#if defined(_WIN32)
+
+struct Logwatch::ChangeNotifier::Backend {
+
+    // NOTE: the OS only reports size changes once the cache manager flushes them,
+    // so the watcher still does a slow full rescan as a safety net.
+    static constexpr DWORD kFilter =
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+        FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+
+    struct Root {
+        fs::path path;
+        HANDLE dir = INVALID_HANDLE_VALUE;
+        OVERLAPPED ov{};
+        std::vector<DWORD> buf = std::vector<DWORD>(16 * 1024); // 64 KB, must be DWORD aligned
+
+        bool arm() {
+            ResetEvent(ov.hEvent);
+            return ReadDirectoryChangesW(dir, buf.data(), DWORD(buf.size() * sizeof(DWORD)),
+                TRUE, kFilter, nullptr, &ov, nullptr);
+        }
+
+        ~Root() {
+            if (dir != INVALID_HANDLE_VALUE) {
+                DWORD unused = 0;
+                if (CancelIoEx(dir, &ov))
+                    GetOverlappedResult(dir, &ov, &unused, TRUE); // buffer must outlive the request
+                CloseHandle(dir);
+            }
+            if (ov.hEvent) CloseHandle(ov.hEvent);
+        }
+    };
+
+    std::vector<std::unique_ptr<Root>> roots;
+    HANDLE interrupt = nullptr;
+
+    Backend() { interrupt = CreateEventW(nullptr, TRUE, FALSE, nullptr); }
+    ~Backend() { roots.clear(); if (interrupt) CloseHandle(interrupt); }
+
+    bool open(const std::vector<fs::path>& paths) {
+        if (!interrupt) return false;
+        for (const auto& p : paths) {
+            auto r = std::make_unique<Root>();
+            r->path = p;
+            r->dir = CreateFileW(p.c_str(), FILE_LIST_DIRECTORY,
+                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+            r->ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            if (r->dir == INVALID_HANDLE_VALUE || !r->ov.hEvent || !r->arm()) {
+                logger::info("ChangeNotifier: cannot watch {} (error {})",
+                    Utils::replaceUsername(Utils::toUTF8(p)), GetLastError());
+                return false;
+            }
+            roots.push_back(std::move(r));
+        }
+        return !roots.empty();
+    }
+};
+
+bool Logwatch::ChangeNotifier::supported() noexcept { return true; }
+
+void Logwatch::ChangeNotifier::run(const std::stop_token& stop) {
+
+    std::stop_callback onStop(stop, [this] { SetEvent(backend->interrupt); });
+
+    std::vector<HANDLE> waits;
+    for (const auto& r : backend->roots) waits.push_back(r->ov.hEvent);
+    waits.push_back(backend->interrupt);
+
+    while (!stop.stop_requested()) {
+
+        const DWORD res = WaitForMultipleObjects(DWORD(waits.size()), waits.data(), FALSE, INFINITE);
+        if (res == WAIT_FAILED) {
+            logger::error("ChangeNotifier: wait failed (error {})", GetLastError());
+            break;
+        }
+
+        const size_t idx = size_t(res - WAIT_OBJECT_0);
+        if (idx >= backend->roots.size()) continue; // interrupt
+
+        auto& root = *backend->roots[idx];
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(root.dir, &root.ov, &bytes, FALSE) || bytes == 0) {
+            markOverflow(); // zero bytes means the buffer overflowed and events were dropped
+        }
+        else {
+            auto* p = reinterpret_cast<const std::byte*>(root.buf.data());
+            for (;;) {
+                const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(p);
+                const std::wstring_view name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+                push(root.path / fs::path(name));
+                if (!info->NextEntryOffset) break;
+                p += info->NextEntryOffset;
+            }
+        }
+
+        const bool armed = root.arm();
+        if (wake) wake();
+
+        if (!armed) {
+            logger::info("ChangeNotifier: lost watch on {} (error {})",
+                Utils::replaceUsername(Utils::toUTF8(root.path)), GetLastError());
+            break;
+        }
+    }
+}
+
+#elif defined(__linux__)
+
+struct Logwatch::ChangeNotifier::Backend {
+
+    static constexpr uint32_t kMask =
+        IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+    int fd = -1;
+    int interrupt = -1;
+    std::unordered_map<int, fs::path> dirs; // inotify isn't recursive, so one watch per directory
+
+    ~Backend() {
+        if (fd >= 0) close(fd);
+        if (interrupt >= 0) close(interrupt);
+    }
+
+    bool watchTree(const fs::path& root) {
+        if (!watchDir(root)) return false;
+        std::error_code ec;
+        auto it = fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, ec);
+        for (fs::recursive_directory_iterator end; !ec && it != end; it.increment(ec)) {
+            if (it->is_directory(ec) && !it->is_symlink(ec)) watchDir(it->path());
+        }
+        return true;
+    }
+
+    bool watchDir(const fs::path& dir) {
+        const int wd = inotify_add_watch(fd, dir.c_str(), kMask);
+        if (wd < 0) return false;
+        dirs[wd] = dir;
+        return true;
+    }
+
+    bool open(const std::vector<fs::path>& paths) {
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        interrupt = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd < 0 || interrupt < 0) return false;
+        for (const auto& p : paths) {
+            if (!watchTree(p)) {
+                logger::info("ChangeNotifier: cannot watch {}", Utils::toUTF8(p));
+                return false;
+            }
+        }
+        return !dirs.empty();
+    }
+};
+
+bool Logwatch::ChangeNotifier::supported() noexcept { return true; }
+
+void Logwatch::ChangeNotifier::run(const std::stop_token& stop) {
+
+    std::stop_callback onStop(stop, [this] {
+        const uint64_t one = 1;
+        (void)!write(backend->interrupt, &one, sizeof(one));
+    });
+
+    alignas(inotify_event) char buf[64 * 1024];
+
+    while (!stop.stop_requested()) {
+
+        pollfd fds[2] = { { backend->fd, POLLIN, 0 }, { backend->interrupt, POLLIN, 0 } };
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            logger::error("ChangeNotifier: poll failed (errno {})", errno);
+            break;
+        }
+        if (!(fds[0].revents & POLLIN)) continue; // interrupt
+
+        bool any = false;
+        for (;;) {
+            const ssize_t n = read(backend->fd, buf, sizeof(buf));
+            if (n <= 0) break;
+            for (const char* p = buf; p < buf + n; ) {
+                const auto* ev = reinterpret_cast<const inotify_event*>(p);
+                p += sizeof(inotify_event) + ev->len;
+                any = true;
+
+                if (ev->mask & IN_Q_OVERFLOW) { markOverflow(); continue; }
+                if (ev->mask & IN_IGNORED) { backend->dirs.erase(ev->wd); continue; }
+
+                const auto it = backend->dirs.find(ev->wd);
+                if (it == backend->dirs.end()) continue;
+
+                auto path = ev->len ? it->second / ev->name : it->second;
+                if ((ev->mask & IN_ISDIR) && (ev->mask & (IN_CREATE | IN_MOVED_TO))) {
+                    // Files may land in it before the watch exists.
+                    backend->watchTree(path);
+                    markOverflow();
+                }
+                push(std::move(path));
+            }
+        }
+
+        if (any && wake) wake();
+    }
+}
+
+#else
+
+struct Logwatch::ChangeNotifier::Backend {
+    bool open(const std::vector<fs::path>&) { return false; }
+};
+
+bool Logwatch::ChangeNotifier::supported() noexcept { return false; }
+
+void Logwatch::ChangeNotifier::run(const std::stop_token&) {}
+
+#endif
+
+Logwatch::ChangeNotifier::ChangeNotifier() = default;
+
+Logwatch::ChangeNotifier::~ChangeNotifier() { stop(); }
+
+bool Logwatch::ChangeNotifier::start(const std::vector<fs::path>& roots, std::function<void()> onChange) {
+    if (!supported() || roots.empty()) return false;
+    if (running()) return true;
+
+    stop(); // reap a backend that died on us
+
+    auto be = std::make_unique<Backend>();
+    if (!be->open(roots)) return false;
+
+    backend = std::move(be);
+    wake = std::move(onChange);
+    alive.store(true, std::memory_order_release);
+
+    worker = std::jthread([this](const std::stop_token& st) {
+        try {
+            run(st);
+        }
+        catch (const std::exception& e) {
+            logger::error("ChangeNotifier thread failed: {}", e.what());
+        }
+        catch (...) {
+            logger::error("ChangeNotifier thread failed for unknown reasons");
+        }
+        markOverflow(); // whatever happened, the watcher has to rescan
+        alive.store(false, std::memory_order_release);
+        if (wake) wake();
+    });
+
+    return true;
+}
+
+void Logwatch::ChangeNotifier::stop() {
+    if (worker.joinable()) {
+        worker.request_stop();
+        worker.join();
+    }
+    alive.store(false, std::memory_order_release);
+    backend.reset();
+    wake = {};
+    std::lock_guard lock(_mutex_);
+    pending.clear();
+    overflowed = false;
+}
+
+void Logwatch::ChangeNotifier::push(fs::path&& p) {
+    std::lock_guard lock(_mutex_);
+    if (overflowed) return; // a full scan is coming anyway
+    if (pending.size() >= kMaxPending) {
+        pending.clear();
+        overflowed = true;
+        return;
+    }
+    pending.push_back(std::move(p));
+}
+
+bool Logwatch::ChangeNotifier::drain(std::vector<fs::path>& out) {
+    bool complete = true;
+    {
+        std::lock_guard lock(_mutex_);
+        out.swap(pending);
+        pending.clear();
+        complete = !overflowed;
+        overflowed = false;
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return complete;
+}
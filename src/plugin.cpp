@@ -27,6 +27,8 @@ static void MessageHandler(SKSE::MessagingInterface::Message* msg) {
         config = Logwatch::watcher.configurator();
         config.loadFromSettings(st);
         Logwatch::aggr.setCapacity(config.cacheCap);
+        Logwatch::aggr.setBudget(MB2B((size_t)config.historyBudgetMB));
+        Logwatch::aggr.setBatchLimit(config.commitBatch);
         Logwatch::watcher.checkRunState();
         Logwatch::watcher.addLogDirectories();
         Logwatch::watcher.startLogWatcher();
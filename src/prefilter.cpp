@@ -0,0 +1,88 @@
+#include <deque>
+#include <algorithm>
+
+#include "prefilter.hpp"
+
+void Logwatch::Prefilter::build(const std::vector<std::vector<std::string>>& keywords) {
+
+    std::fill(std::begin(alpha), std::end(alpha), uint8_t(0));
+    width = 1;
+    all = 0;
+
+    // Alphabet: one column per distinct (lowercased) keyword byte, both cases map to it.
+    for (const auto& list : keywords) {
+        for (const auto& k : list) {
+            for (const char ch : k) {
+                const auto c = lower(static_cast<unsigned char>(ch));
+                if (alpha[c]) continue;
+                alpha[c] = uint8_t(width);
+                if (c >= 'a' && c <= 'z') alpha[c - 'a' + 'A'] = uint8_t(width);
+                ++width;
+            }
+        }
+    }
+
+    // Trie
+    delta.assign(width, -1);
+    out.assign(1, 0);
+
+    for (size_t b = 0; b < keywords.size() && b < 64; ++b) {
+        for (const auto& k : keywords[b]) {
+            if (k.empty()) continue;
+            int s = 0;
+            for (const char ch : k) {
+                const auto col = alpha[lower(static_cast<unsigned char>(ch))];
+                int32_t& next = delta[size_t(s) * width + col];
+                if (next < 0) {
+                    next = int32_t(out.size());
+                    out.push_back(0);
+                    delta.resize(out.size() * width, -1);
+                }
+                s = delta[size_t(s) * width + col];
+            }
+            out[s] |= 1ull << b;
+            all |= 1ull << b;
+        }
+    }
+
+    // Failure links, folded straight into delta so scanning is one lookup per byte.
+    std::vector<int32_t> fail(out.size(), 0);
+    std::deque<int32_t> queue;
+
+    for (size_t col = 0; col < width; ++col) {
+        int32_t& t = delta[col];
+        if (t < 0) t = 0;
+        else queue.push_back(t);
+    }
+
+    while (!queue.empty()) {
+        const int32_t s = queue.front();
+        queue.pop_front();
+        out[s] |= out[fail[s]];
+
+        for (size_t col = 0; col < width; ++col) {
+            int32_t& t = delta[size_t(s) * width + col];
+            const int32_t viaFail = delta[size_t(fail[s]) * width + col];
+            if (t < 0) {
+                t = viaFail;
+            }
+            else {
+                fail[t] = viaFail;
+                queue.push_back(t);
+            }
+        }
+    }
+}
+
+uint64_t Logwatch::Prefilter::scan(const std::string_view& line) const {
+    uint64_t hits = 0;
+    int32_t s = 0;
+    for (const char ch : line) {
+        const auto c = static_cast<unsigned char>(ch);
+        if (isSpace(c)) continue;
+        s = delta[size_t(s) * width + alpha[c]];
+        hits |= out[s];
+        if (hits == all) break;
+    }
+    return hits;
+}
@@ -34,6 +34,8 @@ void Logwatch::applyNow() {
     config.pollInterval = std::chrono::milliseconds{ config.pollIntervalMs };
 
     aggr.setCapacity((size_t)st.cacheCap);
+    aggr.setBudget(MB2B((size_t)st.historyBudgetMB));
+    aggr.setBatchLimit((size_t)st.commitBatch);
 
     Logwatch::Restart::apply_done.store(false, std::memory_order_relaxed);
     Logwatch::Restart::apply_inprogress.store(false, std::memory_order_relaxed);
@@ -2,6 +2,7 @@
 #include "logger.hpp"
 #include "aggregator.hpp"
 #include "settings_json.hpp"
+#include "watcher.hpp"
 #include "utils.hpp"
 
 Logwatch::SettingPersister Logwatch::settingsPersister{};
@@ -39,6 +40,10 @@ void Logwatch::SettingPersister::saveState() {
 			root["pins"] = pins;
 		}
 
+		if (!patterns.is_null()) {
+			root["patterns"] = patterns;
+		}
+
 		fs::create_directories(fs::path(path).parent_path());
 		{
 			std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
@@ -95,6 +100,20 @@ bool Logwatch::SettingPersister::loadState() {
 
 		oldSettings = s;
 
+		if (root.contains("patterns")) {
+			std::vector<LevelPattern> custom;
+			if (from_json_patterns(root["patterns"], custom)) {
+				logger::info("Loaded {} custom level pattern(s)", custom.size());
+
+				// Only happens when they're (re)loaded, so a quick sample right here is fine.
+				constexpr size_t kLines = 2000;
+				const auto bad = Classifier::crossCheck(custom, kLines);
+				if (bad) logger::warn("Custom level patterns: {} of {} test line(s) classified differently than std::regex would", bad, kLines);
+				watcher.configurator().patterns = std::move(custom);
+				patterns = root["patterns"];
+			}
+		}
+
 		if (s.persistPins && root.contains("pins") && root["pins"].is_array()) {
 			const auto pins = root["pins"].get<std::unordered_set<std::string>>();
 			aggr.replacePins(pins);
@@ -111,4 +130,34 @@ bool Logwatch::SettingPersister::loadState() {
 		logger::error("loadState failed: {}", e.what());
 		return false;
 	}
-}
\ No newline at end of file
+}
+
+bool Logwatch::SettingPersister::from_json_patterns(const json& j, std::vector<LevelPattern>& out) {
+	if (!j.is_array() || j.empty()) {
+		logger::error("patterns must be a non-empty array; keeping the defaults");
+		return false;
+	}
+
+	out.clear();
+	for (const auto& p : j) {
+		if (!p.is_object() || !p.contains("name") || !p.contains("regex") || !p["name"].is_string() || !p["regex"].is_string()) {
+			logger::error("Each pattern needs a name and a regex, both strings; keeping the defaults");
+			return false;
+		}
+		if (p.contains("icase") && !p["icase"].is_boolean()) {
+			logger::error("icase must be true or false; keeping the defaults");
+			return false;
+		}
+		const auto name = p["name"].get<std::string>();
+		const auto regex = p["regex"].get<std::string>();
+		const bool icase = p.value("icase", true);
+		try {
+			out.emplace_back(name, regex, icase);
+		}
+		catch (const std::regex_error& e) {
+			logger::error("Pattern '{}' doesn't compile ({}); keeping the defaults", name, e.what());
+			return false;
+		}
+	}
+	return true;
+}
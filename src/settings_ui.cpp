@@ -1,8 +1,10 @@
 #include "live.hpp"
 #include "settings.hpp"
+#include "job.hpp"
 #include "restart.hpp"
 #include "loading.hpp"
 #include "translate.hpp"
+#include "timeline.hpp"
 
 void Live::LogWatcherUI::RenderSettings()
 {
@@ -66,6 +68,16 @@ void Live::LogWatcherUI::RenderSettings()
 			ImGui::SameLine(0.0f, 12.f);
 			ImGui::Checkbox(Trans::Tr("Settings.History.SaveWatch.Label").c_str(), &st.saveWatch);
 			Live::HelpMarker(Trans::Tr("Settings.History.SaveWatch.Tooltip").c_str());
+			ImGui::SameLine(0.0f, 12.f);
+			ImGui::Checkbox(Trans::Tr("Settings.History.SaveTimeline.Label").c_str(), &st.saveTimeline);
+			Live::HelpMarker(Trans::Tr("Settings.History.SaveTimeline.Tooltip").c_str());
+			ImGui::SameLine(0.0f, 12.f);
+			ImGui::BeginDisabled(Logwatch::TimelineReader::exporting());
+			if (ImGui::Button(Trans::Tr("Settings.History.ExportTimeline.Label").c_str())) {
+				Logwatch::TimelineReader::exportCsvAsync();
+			}
+			ImGui::EndDisabled();
+			Live::HelpMarker(Trans::Tr("Settings.History.ExportTimeline.Tooltip").c_str());
 			ImGui::Dummy(ImVec2(0, 4));
 		}
 
@@ -73,6 +85,10 @@ void Live::LogWatcherUI::RenderSettings()
 			ImGui::Dummy(ImVec2(0, 4));
 			ImGui::SliderInt(Trans::Tr("Settings.Cache.Capacity.Label").c_str(), &st.cacheCap, 100, 20000);
 			HelpMarker(Trans::Tr("Settings.Cache.Capacity.Tooltip").c_str());
+			ImGui::SliderInt(Trans::Tr("Settings.Cache.Budget.Label").c_str(), &st.historyBudgetMB, 8, 1024);
+			HelpMarker(Trans::Tr("Settings.Cache.Budget.Tooltip").c_str());
+			ImGui::TextDisabled("%s: %.1f / %zu MB", Trans::Tr("Settings.Cache.Usage.Label").c_str(),
+				double(Logwatch::aggr.historyBytes()) / MB2B(1), size_t(MB(Logwatch::aggr.budgetBytes())));
 			ImGui::Dummy(ImVec2(0, 4));
 		}
 
@@ -84,6 +100,22 @@ void Live::LogWatcherUI::RenderSettings()
 			HelpMarker(Trans::Tr("Settings.Performance.MaxChunk.Tooltip").c_str());
 			ImGui::SliderInt(Trans::Tr("Settings.Performance.MaxLine.Label").c_str(), &st.maxLineKB, 1, 1024);
 			HelpMarker(Trans::Tr("Settings.Performance.MaxLine.Tooltip").c_str());
+			ImGui::TextDisabled("%s: %llu", Trans::Tr("Settings.Performance.StatCalls.Label").c_str(),
+				(unsigned long long)Logwatch::watcher.statCallsPerPoll());
+			HelpMarker(Trans::Tr("Settings.Performance.StatCalls.Tooltip").c_str());
+			if (Logwatch::watcher.prefilterLines()) {
+				ImGui::TextDisabled("%s: %.1f%% of %llu", Trans::Tr("Settings.Performance.Prefilter.Label").c_str(),
+					100.0 * Logwatch::watcher.prefilterPassRatio(), (unsigned long long)Logwatch::watcher.prefilterLines());
+				HelpMarker(Trans::Tr("Settings.Performance.Prefilter.Tooltip").c_str());
+			}
+#ifndef NDEBUG
+			// Debug builds only, no translation on purpose; the result goes to the log.
+			static Logwatch::BackgroundJob selfTest;
+			ImGui::BeginDisabled(selfTest.running());
+			if (ImGui::Button("Classifier self test"))
+				selfTest.start([](const std::stop_token& stop) { Logwatch::Classifier::selfTest(stop); });
+			ImGui::EndDisabled();
+#endif
 			ImGui::Dummy(ImVec2(0, 4));
 
 			ImGui::Checkbox(Trans::Tr("Settings.Performance.WatchPapyrus.Label").c_str(), &st.watchPapyrus);
@@ -0,0 +1,40 @@
+#include "symbols.hpp"
+#include "logger.hpp"
+
+Logwatch::SymbolTable Logwatch::symbols;
+
+Logwatch::SymbolTable::SymbolTable() {
+    intern("");
+}
+
+Logwatch::SymbolTable::~SymbolTable() {
+    for (auto& c : chunks) delete[] c.load(std::memory_order_relaxed);
+}
+
+uint32_t Logwatch::SymbolTable::intern(const std::string_view& s) {
+    std::lock_guard lock(_mutex_);
+    if (auto it = index.find(s); it != index.end()) return it->second;
+    return append(s);
+}
+
+uint32_t Logwatch::SymbolTable::append(const std::string_view& s) {
+    const auto id = count.load(std::memory_order_relaxed);
+    if (id >= kChunkSize * kMaxChunks) {
+        logger::error("Symbol table is full, '{}' is shown as empty", s);
+        return kEmpty;
+    }
+
+    auto* chunk = chunks[id >> kChunkBits].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new std::string[kChunkSize];
+        chunks[id >> kChunkBits].store(chunk, std::memory_order_relaxed);
+    }
+
+    auto& slot = chunk[id & (kChunkSize - 1)];
+    slot.assign(s);
+    index.emplace(slot, id);
+
+    // Publishes the slot (and the chunk pointer) to name().
+    count.store(id + 1, std::memory_order_release);
+    return id;
+}
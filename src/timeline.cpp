@@ -0,0 +1,209 @@
+#include <cstring>
+
+#include "timeline.hpp"
+#include "aggregator.hpp"
+#include "symbols.hpp"
+#include "logger.hpp"
+#include "job.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    fs::path watchDir() {
+        const auto root = fs::path(REL::Module::get().filename()).parent_path();
+        return root / "Data" / "SKSE" / "Plugins" / PRODUCT_NAME / "Watch";
+    }
+
+    // One export at a time, or two of them would write Timeline.csv at once.
+    Logwatch::BackgroundJob exporter;
+
+}
+
+fs::path Logwatch::TimelineWriter::binPath() { return watchDir() / "Timeline.bin"; }
+
+fs::path Logwatch::TimelineWriter::namesPath() { return watchDir() / "Timeline.names"; }
+
+bool Logwatch::TimelineWriter::open(const int64_t& ms) {
+    std::error_code ec;
+    fs::create_directories(watchDir(), ec);
+
+    bin.open(binPath(), std::ios::binary | std::ios::trunc);
+    names.open(namesPath(), std::ios::binary | std::ios::trunc);
+    if (!bin || !names) {
+        logger::error("TimelineWriter failed to open {}, giving up for this session", binPath().string());
+        bin.close();
+        names.close();
+        failed = true;
+        return false;
+    }
+
+    TimelineHeader h;
+    h.startMs = ms;
+    bin.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    bin.flush();
+
+    named.clear();
+    last.clear();
+    since = 0;
+    return true;
+}
+
+void Logwatch::TimelineWriter::append(const int64_t& ms) {
+    if (failed || (!bin.is_open() && !open(ms))) return;
+
+    const auto ch = aggr.changedSince(since);
+    if (!ch.any()) return;
+    const bool first = since == 0;
+    since = ch.version;
+
+    std::vector<TimelineRecord> out;
+    out.reserve(ch.changed.size() + 1);
+
+    // Mods went away; tell the reader to forget everything it had.
+    if (ch.full && !first) {
+        TimelineRecord marker;
+        marker.ms = ms;
+        out.push_back(marker);
+        last.clear();
+    }
+
+    for (const auto& row : ch.changed) {
+        TimelineRecord r;
+        r.ms = ms;
+        r.modId = row.modId;
+        r.errors = uint32_t(row.errors);
+        r.warnings = uint32_t(row.warnings);
+        r.fails = uint32_t(row.fails);
+        r.others = uint32_t(row.others);
+
+        // Evicting history bumps a row's version too, but the counts didn't move.
+        if (row.modId < last.size()) {
+            const auto& l = last[row.modId];
+            if (l.modId && l.errors == r.errors && l.warnings == r.warnings && l.fails == r.fails && l.others == r.others) continue;
+        }
+        else {
+            last.resize(row.modId + 1);
+        }
+        last[row.modId] = r;
+
+        // Name first, so a reader never sees an id it can't look up.
+        if (row.modId >= named.size()) named.resize(row.modId + 1, false);
+        if (!named[row.modId]) {
+            const auto& name = symbols.name(row.modId);
+            const uint32_t id = row.modId;
+            const uint16_t len = uint16_t(std::min<size_t>(name.size(), UINT16_MAX));
+            names.write(reinterpret_cast<const char*>(&id), sizeof(id));
+            names.write(reinterpret_cast<const char*>(&len), sizeof(len));
+            names.write(name.data(), len);
+            named[row.modId] = true;
+        }
+
+        out.push_back(r);
+    }
+
+    if (out.empty()) return;
+
+    names.flush();
+    bin.write(reinterpret_cast<const char*>(out.data()), std::streamsize(out.size() * sizeof(TimelineRecord)));
+    bin.flush();
+
+    if (!bin || !names) {
+        logger::error("TimelineWriter failed to append to {}, giving up for this session", binPath().string());
+        bin.close();
+        names.close();
+        failed = true;
+    }
+}
+
+bool Logwatch::TimelineReader::open(const fs::path& bin, const fs::path& names) {
+    count = 0;
+    dictionary.clear();
+    view = MappedView{};
+
+    std::error_code ec;
+    const auto bytes = fs::file_size(bin, ec);
+    if (ec || bytes < sizeof(TimelineHeader)) return false;
+
+    handle = ReadHandle::open(bin);
+    if (!handle.valid()) return false;
+
+    view = handle.map(0, size_t(bytes));
+    if (!view.valid()) return false;
+
+    std::memcpy(&head, view.data(), sizeof(head));
+    if (std::memcmp(head.magic, "LWTL", 4) != 0 || head.version != 1) {
+        logger::error("{} is not a timeline", bin.string());
+        view = MappedView{};
+        return false;
+    }
+    count = (view.size() - sizeof(TimelineHeader)) / sizeof(TimelineRecord);
+
+    std::ifstream in(names, std::ios::binary);
+    while (in) {
+        uint32_t id = 0;
+        uint16_t len = 0;
+        if (!in.read(reinterpret_cast<char*>(&id), sizeof(id))) break;
+        if (!in.read(reinterpret_cast<char*>(&len), sizeof(len))) break;
+        std::string name(len, '\0');
+        if (!in.read(name.data(), len)) break;
+        dictionary.emplace(id, std::move(name));
+    }
+    return true;
+}
+
+Logwatch::TimelineRecord Logwatch::TimelineReader::at(const size_t& i) const {
+    // memcpy, the view makes no promises about alignment.
+    TimelineRecord r;
+    std::memcpy(&r, view.data() + sizeof(TimelineHeader) + i * sizeof(TimelineRecord), sizeof(r));
+    return r;
+}
+
+std::string_view Logwatch::TimelineReader::name(const uint32_t& modId) const {
+    const auto it = dictionary.find(modId);
+    return it == dictionary.end() ? std::string_view{} : std::string_view(it->second);
+}
+
+void Logwatch::TimelineReader::writeCsv(std::ostream& out) const {
+    out << "time_ms,elapsed_s,mod,errors,warnings,fails,others\n";
+    for (size_t i = 0; i < count; ++i) {
+        const auto r = at(i);
+        if (!r.modId) continue;
+
+        // Mod names are file stems; quote the odd one with a comma or quote in it.
+        const auto mod = name(r.modId);
+        out << r.ms << ',' << double(r.ms - head.startMs) / 1000.0 << ',';
+        if (mod.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out << mod;
+        }
+        else {
+            out << '"';
+            for (const char c : mod) {
+                if (c == '"') out << '"';
+                out << c;
+            }
+            out << '"';
+        }
+        out << ',' << r.errors << ',' << r.warnings << ',' << r.fails << ',' << r.others << '\n';
+    }
+}
+
+bool Logwatch::TimelineReader::exporting() { return exporter.running(); }
+
+bool Logwatch::TimelineReader::exportCsvAsync() {
+    return exporter.start([](const std::stop_token&) {
+        TimelineReader reader;
+        if (!reader.open(TimelineWriter::binPath(), TimelineWriter::namesPath())) {
+            logger::info("No timeline to export yet");
+            return;
+        }
+        const auto csvPath = watchDir() / "Timeline.csv";
+        std::ofstream csv(csvPath, std::ios::trunc);
+        if (!csv) {
+            logger::error("Timeline export failed to open {}", csvPath.string());
+            return;
+        }
+        reader.writeCsv(csv);
+        logger::info("Exported {} timeline record(s) to {}", reader.size(), csvPath.string());
+    });
+}
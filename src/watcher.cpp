@@ -9,134 +9,29 @@
 #include "logger.hpp"
 #include "documents.hpp"
 #include "aggregator.hpp"
+#include "linescan.hpp"
+#include "symbols.hpp"
 
 Logwatch::LogWatcher Logwatch::watcher;
 
-std::string Logwatch::LogWatcher::watchSnapshotPath(const std::string& ext) const {
-    const auto root = fs::path(REL::Module::get().filename()).parent_path();
-	const std::string fileName = "WatchSnapshot." + ext;
-    return (root / "Data" / "SKSE" / "Plugins" / PRODUCT_NAME / "Watch" / fileName).string();
-}
-
-std::string Logwatch::LogWatcher::watchTimeStamp() const {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-
-    std::tm tm{};
-#if defined(_WIN32)
-    localtime_s(&tm, &time);
-#else
-    localtime_r(&t, &tm);
-#endif
-
-    std::ostringstream out;
-    out << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    return out.str();
-}
-
-void Logwatch::LogWatcher::getSortedSnapshot(std::vector<std::pair<std::string, Counts>>& sorted, const Snapshot& snap) const {
-    sorted.reserve(snap.size());
-    for (const auto& [modKey, s] : snap) {
-        Counts c;
-        c.errors = s.errors;
-        c.warnings = s.warnings;
-        c.fails = s.fails;
-        c.others = s.others;
-        sorted.emplace_back(modKey, c);
-    }
-    std::sort(sorted.begin(), sorted.end(),
-        [](const auto& a, const auto& b) {
-            return a.first < b.first;
-        });
-}
-
-size_t Logwatch::LogWatcher::hashWatchSnapshot(const Snapshot& snap) const {
-    std::vector<std::pair<std::string, Counts>> sortedSnap;
-	getSortedSnapshot(sortedSnap, snap);
-
-	// Same as FNV-1a, but we mix in counts for each mod.
-    constexpr uint64_t FNV_OFFSET = 1469598103934665603ull;
-    constexpr uint64_t FNV_PRIME = 1099511628211ull;
-
-    uint64_t h = FNV_OFFSET;
-
-    for (const auto& [mod, s] : snap) {
-
-        uint64_t he = FNV_OFFSET;
-        for (unsigned char c : mod) {
-            he ^= c;
-            he *= FNV_PRIME;
-        }
-
-#define mix(count) he ^= count; he *= FNV_PRIME;
-
-        mix(s.errors);
-        mix(s.warnings);
-        mix(s.fails);
-        mix(s.others);
-
-        h ^= he;
-        h *= FNV_PRIME;
-    }
-
-    return size_t(h);
-}
-
-inline void writeWatchToFile(std::ofstream& to, const std::string& ts, const std::vector<std::pair<std::string, Logwatch::Counts>>& sortedSnap) {
-    to << "-----[ Watch Snapshot @ " << ts << " ]--------------\n";
-    for (const auto& [mod, c] : sortedSnap) {
-        to << mod
-            << ", " << c.errors << " errors"
-            << ", " << c.warnings << " warnings"
-            << ", " << c.fails << " fails"
-            << ", " << c.others << " others"
-            << "\n";
-    }
-    to << "\n";
-    to.flush();
-}
-
-void Logwatch::LogWatcher::saveWatchIfChanged(const Snapshot& snap) {
-    if (!config.saveWatch) return;
+void Logwatch::LogWatcher::saveWatchIfChanged() {
+    if (!config.saveWatch && !config.saveTimeline) return;
 
-    const size_t currentHash = hashWatchSnapshot(snap);
+    // The aggregator keeps this up to date as matches come in, so an unchanged watch
+    // costs one load. Sorting and the disk happen on the writer's thread.
+    const uint64_t currentHash = aggr.watchHash();
     if (currentHash == lastWatchHash) return;
     lastWatchHash = currentHash;
 
-    const auto outPath = watchSnapshotPath("log");
-    const auto csvPath = watchSnapshotPath("csv");
-    fs::create_directories(fs::path(outPath).parent_path());
-
-    std::vector<std::pair<std::string, Counts>> sortedSnap;
-    getSortedSnapshot(sortedSnap, snap);
-
-    const std::string ts = watchTimeStamp();
-
-    try {
-        std::ofstream out(outPath, std::ios::trunc);
-        std::ofstream csv(csvPath, std::ios::trunc);
-        if (!out) {
-            logger::error("saveWatchIfChanged failed to open {}", outPath);
-            return;
-        }
-        if (!csv) {
-            logger::error("saveWatchIfChanged failed to open {}", csvPath);
-            return;
-        }
-
-		writeWatchToFile(out, ts, sortedSnap);
-		writeWatchToFile(csv, ts, sortedSnap);
-    }
-    catch (const std::exception& e) {
-        logger::error("saveWatchIfChanged failed due to {}", e.what());
-    }
+    watchWriter.submit(aggr.counts(), config.saveWatch, config.saveTimeline);
 }
 
-void Logwatch::OnMatch(const Match& m) {
-    if (m.file.find("Log Watcher") == std::string::npos) {
-        SKSE::log::debug("File:{} Level:{} Line No.:{}", m.file, m.level, m.lineNo);
+void Logwatch::OnMatch(Match&& m) {
+    const auto& file = symbols.name(m.fileId);
+    if (file.find("Log Watcher") == std::string::npos) {
+        SKSE::log::debug("File:{} Level:{} Line No.:{}", file, LevelName(m.level), m.lineNo);
     }
-    aggr.add(m);
+    aggr.add(std::move(m));
 }
 
 Logwatch::LogType Logwatch::classify(const std::filesystem::path& p) {
@@ -152,45 +47,78 @@ bool Logwatch::LogWatcher::shouldInclude(const fs::path& file) const {
     return true;
 }
 
-void Logwatch::LogWatcher::discoverFiles(std::vector<fs::path>& out, const fs::path& root, const std::stop_token& stop) {
+void Logwatch::LogWatcher::discoverFiles(std::vector<DiscoveredFile>& out, const fs::path& root, const std::stop_token& stop) {
+    // Only directories whose mtime moved get enumerated again; see DirCache.
+    dirCache.collect(root, [this](const fs::path& p) { return shouldInclude(p); }, out, stop);
+}
 
-    std::error_code ec;
-    if (!fs::exists(root, ec) || !fs::is_directory(root, ec)) return;
+bool Logwatch::LogWatcher::useNotifier() {
+    if (!config.eventDriven || notifierUnavailable) {
+        notifier.stop();
+        return false;
+    }
 
-    auto it = fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, ec);
-    fs::recursive_directory_iterator end;
+    if (notifier.running()) return true;
 
-    if (ec) {
-        const std::string rootToPrint = Utils::replaceUsername(Utils::toUTF8(root));
-        logger::info("discoverFiles: cannot iterate over {}: {}", rootToPrint, ec.message());
-        return;
+    std::vector<fs::path> watchRoots;
+    {
+        std::lock_guard lock(_mutex_);
+        watchRoots = roots;
     }
 
-    while (it != end) {
+    // Take the wake mutex before notifying so the wakeup can't slip in between
+    // the worker checking its predicate and going to sleep.
+    const bool started = notifier.start(watchRoots, [this] {
+        { std::lock_guard wake_lock(_wake_mutex_); }
+        nudge();
+    });
+
+    if (!started) {
+        logger::info("Change notifications unavailable; falling back to polling every {} ms", config.pollIntervalMs);
+        notifierUnavailable = true;
+        return false;
+    }
 
-        if (stop.stop_requested()) break;
+    logger::info("Watching for file changes; full rescan every {} s", config.eventRescanSec);
+    return true;
+}
 
-        const auto& p = it->path();
-        
-        // collect files
-        if (fs::is_regular_file(p, ec) && shouldInclude(p)) {
-            out.push_back(p);
-        }
+void Logwatch::LogWatcher::sleepUntilNextPoll(const std::stop_token& stop, const bool& evented) {
 
-        ec.clear();
+    // Long enough for a burst of writes to settle so one pass picks them all up.
+    constexpr auto EVENT_SETTLE = std::chrono::milliseconds(50);
 
-        it.increment(ec); // increment iterator safely
+    const auto interrupted = [&] {
+        return stop.stop_requested() || getRunState() == RunState::Stopped;
+    };
 
-        if (ec) {
-            const std::string rootToPrint = Utils::replaceUsername(Utils::toUTF8(root));
-            logger::info("discoverFiles: skipping path under {}: {}", rootToPrint, ec.message());
-            ec.clear();
+    std::unique_lock wake_lock(_wake_mutex_);
+
+    if (!evented) {
+        // get poll interval without keeping _mutex_ locked
+        std::chrono::milliseconds sleep_for;
+        {
+            std::lock_guard lock(_mutex_);
+            sleep_for = config.pollInterval;
         }
+        _wake_cv_.wait_until(wake_lock, Clock::now() + sleep_for, interrupted);
+        return;
     }
+
+    // Sleep until something is written (or the notifier died), with the rescan as a deadline.
+    const bool woken = _wake_cv_.wait_until(wake_lock, nextFullScanAt,
+        [&] { return interrupted() || notifier.hasPending() || !notifier.running(); });
+
+    if (woken && !interrupted())
+        _wake_cv_.wait_for(wake_lock, EVENT_SETTLE, interrupted);
 }
 
 void Logwatch::LogWatcher::watcherLoop(const std::stop_token& stop) {
 
+    notifierUnavailable = false;
+    uint64_t polls = 0, totalStatCalls = 0;
+    watchWriter.start();
+
     while (!stop.stop_requested()) {
 
         if (!isFirstPollDone()) {
@@ -200,6 +128,7 @@ void Logwatch::LogWatcher::watcherLoop(const std::stop_token& stop) {
 		// Handle paused state
         if (getRunState() == RunState::Stopped) {
             logger::info("Watcher paused; sleeping until resumed");
+            notifier.stop(); // nothing to listen for while paused
             std::unique_lock wake_lock(_wake_mutex_);
             _wake_cv_.wait(
                 wake_lock,
@@ -210,7 +139,28 @@ void Logwatch::LogWatcher::watcherLoop(const std::stop_token& stop) {
             continue;
         }
 
-        scanOnce(stop); // Unlocked scan (only critical parts have locks)
+        // Drain before scanning; anything written during the scan wakes us up again.
+        const bool evented = useNotifier();
+        std::vector<fs::path> changed;
+        const bool complete = evented && notifier.drain(changed);
+
+        statusCache.beginPoll();
+
+        if (!complete || !isFirstPollDone() || Clock::now() >= nextFullScanAt) {
+            scanOnce(stop); // Unlocked scan (only critical parts have locks)
+            nextFullScanAt = Clock::now() + std::chrono::seconds(std::max<size_t>(config.eventRescanSec, 1));
+        }
+        else if (!changed.empty()) {
+            scanChanged(changed, stop);
+        }
+
+        const auto statCalls = statusCache.pollSyscalls();
+        lastPollStatCalls.store(statCalls, std::memory_order_relaxed);
+        totalStatCalls += statCalls;
+        ++polls;
+        SKSE::log::debug("Poll {} made {} stat call(s) for {} file(s)", polls, statCalls, files.size());
+        linesClassified.store(classifier.prefilterLines(), std::memory_order_relaxed);
+        linesFullyMatched.store(classifier.prefilterPassed(), std::memory_order_relaxed);
 
         resetWarmingUp();
 
@@ -218,10 +168,10 @@ void Logwatch::LogWatcher::watcherLoop(const std::stop_token& stop) {
 
         // Schedule notifications / mails
         if (!stop.stop_requested()) {
-            const auto snap = aggr.snapshot();
-			saveWatchIfChanged(snap);
-            mayNotifyPinnedAlerts(snap);
-            mayNorifyPeriodicAlerts(snap);
+            aggr.commit();
+			saveWatchIfChanged();
+            mayNotifyPinnedAlerts();
+            mayNorifyPeriodicAlerts();
         }
 
 		// Handle auto-stop after first poll
@@ -231,21 +181,37 @@ void Logwatch::LogWatcher::watcherLoop(const std::stop_token& stop) {
             continue;
 		}
 
-        // get poll interval without keeping _mutex_ locked
-        std::chrono::milliseconds sleep_for;
-        {
-            std::lock_guard lock(_mutex_);
-            sleep_for = config.pollInterval;
-        }
-
 		// Stop-aware and paused-aware sleep
-        std::unique_lock wake_lock(_wake_mutex_);
-        const auto until = Clock::now() + sleep_for;
-        _wake_cv_.wait_until( wake_lock, until, 
-            [&] { 
-                return stop.stop_requested() || getRunState() == RunState::Stopped;
-            } 
-        );
+        sleepUntilNextPoll(stop, evented);
+    }
+
+    notifier.stop();
+
+    if (polls) {
+        logger::info("Watcher made {} stat call(s) in {} poll(s), {:.1f} per poll",
+            totalStatCalls, polls, double(totalStatCalls) / double(polls));
+    }
+
+    const auto opened = handles.openCount(), reused = handles.reuseCount();
+    if (opened + reused) {
+        logger::info("Handle pool opened {} file(s) and reused an open handle {} time(s) ({:.1f}% reuse)",
+            opened, reused, 100.0 * double(reused) / double(opened + reused));
+    }
+
+    const auto seen = classifier.prefilterLines();
+    if (seen) {
+        logger::info("Keyword prefilter sent {} of {} line(s) to the full match ({:.1f}%)",
+            classifier.prefilterPassed(), seen, 100.0 * double(classifier.prefilterPassed()) / double(seen));
+    }
+
+    aggr.commit();
+    saveWatchIfChanged();
+    watchWriter.stop(); // flushes the last one
+
+    const auto ls = aggr.lockStats();
+    if (ls.commits) {
+        logger::info("Aggregator took {} match(es) in {} batch(es) of up to {}, exclusive lock held {:.2f} ms in total, {:.1f} us at most",
+            ls.matches, ls.commits, config.commitBatch, double(ls.holdNs) / 1e6, double(ls.maxHoldNs) / 1e3);
     }
 
     logger::info("Watcher thread exited");
@@ -253,54 +219,20 @@ void Logwatch::LogWatcher::watcherLoop(const std::stop_token& stop) {
 
 void Logwatch::LogWatcher::scanOnce(const std::stop_token& stop) {
 
-    std::vector<fs::path> discovered;
+    std::vector<DiscoveredFile> discovered;
     discovered.reserve(64);
+    dirCache.beginPass();
     for (const auto& r : roots) {
         if (stop.stop_requested()) return;
         discoverFiles(discovered, r, stop);
     }
 
-    for (const auto& p : discovered) {
-        if (stop.stop_requested()) return;
-
-        std::error_code ec;
-        const auto canonPath = fs::weakly_canonical(p, ec);
-        const auto canon = Utils::toUTF8(canonPath);
-
-		// critical section: check if we need to insert
-        bool need_insert = false;
-        bool start_from_end = false;
-        {
-            std::lock_guard lock(_mutex_);
-            need_insert = (files.find(canon) == files.end());
-            start_from_end = !config.deepScan;
-        }
-
-        if (!need_insert) continue;
-
-		// Prepare FileInfo outside lock
-        FileInfo fi;
-        fi.path = p;
-        fi.type = classify(fi.path);
-
-        fi.state.writeTime = fs::last_write_time(p, ec);
-        fi.state.sizeLastSeen = fs::file_size(p, ec);
-        fi.state.lastPoll = Clock::now();
-
-        if (ec) ec.clear();
-        std::error_code ec2;
-        const auto sz = fs::file_size(p, ec2);
-        fi.state.sizeLastSeen = ec2 ? 0 : sz;
-        fi.state.offset = start_from_end ? fi.state.sizeLastSeen : 0;
-        fi.state.lineNo = 0;
+    if (stop.stop_requested()) return;
+    dirCache.sweep();
 
-		// critical section: insert file if still not present
-        {
-            std::lock_guard lock(_mutex_);
-            if (files.find(canon) == files.end()) {
-                files.emplace(canon, std::move(fi));
-            }
-        }
+    for (const auto& d : discovered) {
+        if (stop.stop_requested()) return;
+        trackFile(d.path, d.canon);
     }
 
     if (stop.stop_requested()) return;
@@ -316,67 +248,149 @@ void Logwatch::LogWatcher::scanOnce(const std::stop_token& stop) {
 	// Work unlocked through the cached keys
     for (const auto& key : keys) {
         if (stop.stop_requested()) return;
+        pollFile(key, stop);
+    }
+}
 
-		// get state snapshot under lock
-        FileInfo snap;
-        {
-            std::lock_guard lock(_mutex_);
-            auto it = files.find(key);
-            if (it == files.end()) continue;
-			snap = it->second; 
-        }
+void Logwatch::LogWatcher::scanChanged(const std::vector<fs::path>& changed, const std::stop_token& stop) {
+
+    for (const auto& p : changed) {
+        if (stop.stop_requested()) return;
 
-        // I/O phase (unlocked)
         std::error_code ec;
-        const bool exists = fs::exists(snap.path, ec);
-        const auto size = exists ? fs::file_size(snap.path, ec) : 0ull;
-        const auto wt = exists ? fs::last_write_time(snap.path, ec) : decltype(snap.state.writeTime){};
+        const auto canon = Utils::toUTF8(fs::weakly_canonical(p, ec));
 
-        // Erase locked if the file vanished
-        if (!exists) {
+        bool known = false;
+        {
             std::lock_guard lock(_mutex_);
-            auto it = files.find(key);
-            if (it != files.end()) files.erase(it);
-            continue;
+            known = files.contains(canon);
         }
 
-        // Handle truncation/rotation in the snapshot
-        if (size < snap.state.offset) {
-            snap.state.offset = 0;
-            snap.state.lineNo = 0;
+        // New files go through the same filter as discovery; deletions are
+        // handled by pollFile when it finds the file gone.
+        if (!known) {
+            if (!fs::is_regular_file(p, ec) || !shouldInclude(p)) continue;
+            trackFile(p, canon);
         }
 
-        // Tail if there is new data
-        bool tailed = false;
-        if (size > snap.state.offset) {
-            tailFile(snap, stop);
-            tailed = true;
+        pollFile(canon, stop);
+    }
+}
+
+void Logwatch::LogWatcher::trackFile(const fs::path& p, const std::string& canon) {
+
+	// critical section: check if we need to insert
+    bool need_insert = false;
+    bool start_from_end = false;
+    {
+        std::lock_guard lock(_mutex_);
+        need_insert = (files.find(canon) == files.end());
+        start_from_end = !config.deepScan;
+    }
+
+    if (!need_insert) return;
+
+	// Prepare FileInfo outside lock (the stat is reused by the poll right after)
+    const auto& status = statusCache.get(canon, p);
+
+    FileInfo fi;
+    fi.path = p;
+    const auto name = Utils::spacify(Utils::toUTF8(p.filename()));
+    fi.fileId = symbols.intern(name);
+    fi.modId = symbols.intern(Aggregator::keyOfFast(name));
+    fi.type = classify(fi.path);
+
+    fi.state.writeTime = status.writeTime;
+    fi.state.sizeLastSeen = status.exists ? status.size : 0;
+    fi.state.lastPoll = Clock::now();
+    fi.state.offset = start_from_end ? fi.state.sizeLastSeen : 0;
+    fi.state.lineNo = 0;
+
+	// critical section: insert file if still not present
+    {
+        std::lock_guard lock(_mutex_);
+        if (files.find(canon) == files.end()) {
+            files.emplace(canon, std::move(fi));
         }
+    }
+}
 
-		// Commit updated state back under lock
-        {
-            std::lock_guard lock(_mutex_);
-            auto fit = files.find(key);
-            if (fit == files.end()) continue;
+void Logwatch::LogWatcher::pollFile(const std::string& key, const std::stop_token& stop) {
 
-            auto& fi = fit->second;
-            if (!fs::exists(fi.path, ec)) { files.erase(fit); continue; }
+	// get state snapshot under lock
+    FileInfo snap;
+    {
+        std::lock_guard lock(_mutex_);
+        auto it = files.find(key);
+        if (it == files.end()) return;
+		snap = it->second; 
+    }
 
-            fi.state.sizeLastSeen = size;
-            fi.state.writeTime = wt;
-            if (tailed) {
-                fi.state.offset = snap.state.offset;
-                fi.state.lineNo = snap.state.lineNo;
-            }
+    // I/O phase (unlocked), a single stat shared with discovery and the commit
+    const auto status = statusCache.get(key, snap.path);
+    const auto size = status.size;
+    const auto wt = status.writeTime;
+
+    // Erase locked if the file vanished
+    if (!status.exists) {
+        handles.release(key);
+        std::lock_guard lock(_mutex_);
+        auto it = files.find(key);
+        if (it != files.end()) files.erase(it);
+        return;
+    }
+
+    // Handle truncation/rotation in the snapshot
+    if (size < snap.state.offset) {
+        snap.state.offset = 0;
+        snap.state.lineNo = 0;
+        snap.state.carry.clear();
+        snap.state.skipLine = false;
+        handles.release(key);
+    }
+
+    // Tail if there is new data
+    constexpr auto CARRY_FLUSH_AFTER = std::chrono::seconds(2);
+    bool tailed = false;
+    if (size > snap.state.offset) {
+        tailFile(key, snap, status, stop);
+        tailed = true;
+    }
+    else if (!snap.state.carry.empty() && Clock::now() - snap.state.carrySince >= CARRY_FLUSH_AFTER) {
+        // Writer went quiet without ending its last line, so don't sit on it forever.
+        emitLine(snap, snap.state.carry);
+        snap.state.carry.clear();
+        // If it does finish the line later, that rest isn't a line of its own.
+        snap.state.skipLine = true;
+        tailed = true;
+    }
+
+    // Whatever this file matched goes to the aggregator in one go.
+    if (tailed) aggr.commit();
+
+	// Commit updated state back under lock
+    {
+        std::lock_guard lock(_mutex_);
+        auto fit = files.find(key);
+        if (fit == files.end()) return;
+
+        auto& fi = fit->second;
+        fi.state.sizeLastSeen = size;
+        fi.state.writeTime = wt;
+        if (tailed) {
+            fi.state.offset = snap.state.offset;
+            fi.state.lineNo = snap.state.lineNo;
+            fi.state.carry = std::move(snap.state.carry);
+            fi.state.carrySince = snap.state.carrySince;
+            fi.state.skipLine = snap.state.skipLine;
         }
     }
 }
 
 
-void Logwatch::LogWatcher::tailFile(FileInfo& fi, const std::stop_token& stop) {
-    std::error_code ec;
-    const auto size = fs::file_size(fi.path, ec);
-    if (ec || size <= fi.state.offset) return;
+void Logwatch::LogWatcher::tailFile(const std::string& key, FileInfo& fi, const FileStatus& status, const std::stop_token& stop) {
+    const auto& size = status.size;
+    if (size <= fi.state.offset) return;
 
     size_t chunkCap = KB2B(fi.type == LogType::Papyrus ? config.papyrusMaxChunkKB : config.maxChunkKB);
 
@@ -392,77 +406,106 @@ void Logwatch::LogWatcher::tailFile(FileInfo& fi, const std::stop_token& stop) {
 
     if (stop.stop_requested()) return;
 
-    std::ifstream in(fi.path, std::ios::binary);
+    // Pooled handle, reopened only when the path now names another file (rotation).
+    const auto* in = handles.acquire(key, fi.path, status.id);
     if (!in) return;
 
-    in.seekg(static_cast<std::streamoff>(fi.state.offset), std::ios::beg);
-    
-    std::string buf;
-    buf.resize(toRead);
-    in.read(&buf[0], static_cast<std::streamsize>(toRead));
+    // Big chunks (deep scans, boosted backlog) can be parsed straight off a mapped view.
+    // Below a MB the copy is cheaper than setting up the mapping.
+    constexpr uint64_t MAP_MIN_BYTES = MB2B(1);
+    if (config.mapChunks && toRead >= MAP_MIN_BYTES) {
+        const auto view = in->map(fi.state.offset, static_cast<size_t>(toRead));
+        if (view.valid()) {
+            fi.state.offset += view.size();
+            parseBufferAndEmit(fi, std::string_view(view.data(), view.size()), stop);
+            return;
+        }
+    }
 
-    const auto offset = static_cast<size_t>(in.gcount());
-    buf.resize(offset);
+    // Otherwise read into the reused buffer, no allocation once it reached the chunk cap.
+    char* buf = chunkBuf.reserve(static_cast<size_t>(toRead));
+    const auto offset = in->readAt(fi.state.offset, buf, static_cast<size_t>(toRead));
     fi.state.offset += offset;
 
-    parseBufferAndEmit(fi, std::move(buf), stop);
+    parseBufferAndEmit(fi, std::string_view(buf, offset), stop);
 }
 
-void Logwatch::LogWatcher::parseBufferAndEmit(FileInfo& fi, std::string&& chunk, const std::stop_token& stop) {
+void Logwatch::LogWatcher::parseBufferAndEmit(FileInfo& fi, const std::string_view& chunk, const std::stop_token& stop) {
     
     const size_t lineCap = KB2B(fi.type == LogType::Papyrus ? config.papyrusMaxLineKB : config.maxLineKB);
+    auto& st = fi.state;
+
+    // All line breaks of the chunk in one vectorized pass.
+    lineBreaks.clear();
+    LineScan::findBreaks(chunk, lineBreaks);
 
     size_t start = 0;
-    while (start < chunk.size() && !stop.stop_requested()) {
-        size_t end = chunk.find_first_of("\r\n", start);
-        if (end == std::string::npos) end = chunk.size();
-
-        const size_t len = end - start;
-        if (len <= lineCap) {
-            // This must be string_view to avoid allocating enw memory for chunk.
-            std::string_view sv(&chunk[start], len);
-            auto line = Utils::trimLine(sv);
-            if (!line.empty()) {
-                ++fi.state.lineNo;
-                emitIfMatch(fi.path, line, fi.state.lineNo);
-            }
-        }
+    for (const size_t end : lineBreaks) {
+        if (stop.stop_requested()) return;
+
+        // the LF of a CRLF we already ate
+        if (end < start) continue;
 
-        // eat newline chars
-        if (end < chunk.size()) {
-            if (chunk[end] == '\r' && end + 1 < chunk.size() && chunk[end + 1] == '\n')
-                start = end + 2;
-            else
-                start = end + 1;
+        const auto piece = chunk.substr(start, end - start);
+        if (st.skipLine) {
+            // over-long or already flushed line finally ended, drop the rest of it
+            st.skipLine = false;
+        }
+        else if (!st.carry.empty()) {
+            if (st.carry.size() + piece.size() <= lineCap) {
+                st.carry.append(piece);
+                emitLine(fi, st.carry);
+            }
+            st.carry.clear();
         }
-        else {
-            start = end;
+        else if (piece.size() <= lineCap) {
+            emitLine(fi, piece);
         }
+
+        // eat newline chars (a CRLF split between chunks leaves an empty line, which isn't counted)
+        if (chunk[end] == '\r' && end + 1 < chunk.size() && chunk[end + 1] == '\n')
+            start = end + 2;
+        else
+            start = end + 1;
+    }
+
+    // Chunk ended mid-line: keep the tail until its newline shows up next poll.
+    if (start >= chunk.size() || st.skipLine || stop.stop_requested()) return;
+
+    const auto tail = chunk.substr(start);
+    if (st.carry.size() + tail.size() > lineCap) {
+        st.carry.clear();
+        st.skipLine = true;
+        return;
     }
+    if (st.carry.empty()) st.carrySince = Clock::now();
+    st.carry.append(tail);
 }
 
-void Logwatch::LogWatcher::emitIfMatch(const fs::path& file, const std::string_view& line, const uint64_t& lineNo) {
-    for (const auto& [name, rx] : config.patterns) {
-        if (std::regex_search(line.begin(), line.end(), rx)) {
-            if (callback) {
-                Match m;
-                const auto fileName = Utils::toUTF8(file.filename());
-                m.file = Utils::spacify(fileName);
-                m.line = Utils::nukeLogLine(std::string(line));
-                m.keyword = name;
-                if (name == "error")        m.level = "error";
-                else if (name == "warning") m.level = "warning";
-                else if (name == "fail")    m.level = "fail";
-                else                        m.level = "other";
-                m.lineNo = lineNo;
-                m.when = std::chrono::system_clock::now();
-                callback(m);
-            }
-            return; // stop after first matching pattern
-        }
+void Logwatch::LogWatcher::emitLine(FileInfo& fi, const std::string_view& raw) {
+    auto line = Utils::trimLine(raw);
+    if (!line.empty()) {
+        ++fi.state.lineNo;
+        emitIfMatch(fi, line, fi.state.lineNo);
     }
 }
 
+void Logwatch::LogWatcher::emitIfMatch(const FileInfo& fi, const std::string_view& line, const uint64_t& lineNo) {
+    // One pass over the line for all patterns; first one in config order wins.
+    const int hit = defaultLevels ? DefaultLevels::classify(line) : classifier.classify(line);
+    if (hit < 0 || !callback) return;
+
+    Match m;
+    m.fileId = fi.fileId;
+    m.modId = fi.modId;
+    m.line = std::string(line);  // normalized on first display, see ModStats::Record
+    m.keyword = patternIds[hit];
+    m.level = patternLevels[hit];
+    m.lineNo = lineNo;
+    m.when = std::chrono::system_clock::now();
+    callback(std::move(m));
+}
+
 void Logwatch::LogWatcher::addLogDirectories() {
     const auto gameRoot = std::filesystem::path(REL::Module::get().filename()).parent_path();
     addIfExists(gameRoot / "Data" / "SKSE" / "Plugins");
@@ -526,6 +569,7 @@ void Logwatch::LogWatcher::startLogWatcher() {
 
         logger::info("Watcher started with configuration:");
         config.print();
+        logger::info("Line scanner: {}", LineScan::implementation());
     }
     catch (const std::exception& e) {
         logger::error("Watcher start failed: {}", e.what());
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+
+#include "watchwriter.hpp"
+#include "symbols.hpp"
+#include "logger.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    struct Row {
+        std::string_view mod;
+        const Logwatch::ModCounts* c;
+    };
+
+    // Quotes only when it has to; mod names are file stems, so commas are rare but legal.
+    void csvField(std::ostringstream& out, const std::string_view& s) {
+        if (s.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out << s;
+            return;
+        }
+        out << '"';
+        for (const char c : s) {
+            if (c == '"') out << '"';
+            out << c;
+        }
+        out << '"';
+    }
+
+}
+
+std::string Logwatch::WatchWriter::path(const std::string_view& ext) {
+    const auto root = fs::path(REL::Module::get().filename()).parent_path();
+    const std::string fileName = "WatchSnapshot." + std::string(ext);
+    return (root / "Data" / "SKSE" / "Plugins" / PRODUCT_NAME / "Watch" / fileName).string();
+}
+
+std::string Logwatch::WatchWriter::timeStamp(const std::chrono::system_clock::time_point& at) {
+    auto time = std::chrono::system_clock::to_time_t(at);
+
+    std::tm tm{};
+#if defined(_WIN32)
+    localtime_s(&tm, &time);
+#else
+    localtime_r(&time, &tm);
+#endif
+
+    std::ostringstream out;
+    out << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
+    return out.str();
+}
+
+bool Logwatch::WatchWriter::replaceFile(const std::string& path, const std::string& contents) {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            logger::error("WatchWriter failed to open {}", tmp);
+            return false;
+        }
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        out.flush();
+        if (!out) {
+            logger::error("WatchWriter failed to write {}", tmp);
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    // Replaces the old one in one go (MoveFileEx with REPLACE_EXISTING on Windows).
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        logger::error("WatchWriter failed to replace {}: {}", path, ec.message());
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+void Logwatch::WatchWriter::write(const CountsTable& table, const std::chrono::system_clock::time_point& at) const {
+
+    // Sorted by name here, off the watcher thread; the table itself is by modId.
+    std::vector<Row> rows;
+    rows.reserve(table.size());
+    for (const auto& c : table) rows.push_back({ symbols.name(c.modId), &c });
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.mod < b.mod; });
+
+    const std::string ts = timeStamp(at);
+
+    std::ostringstream log;
+    log << "-----[ Watch Snapshot @ " << ts << " ]--------------\n";
+    for (const auto& r : rows) {
+        log << r.mod
+            << ", " << r.c->errors << " errors"
+            << ", " << r.c->warnings << " warnings"
+            << ", " << r.c->fails << " fails"
+            << ", " << r.c->others << " others"
+            << "\n";
+    }
+    log << "\n";
+
+    std::ostringstream csv;
+    csv << "timestamp,mod,errors,warnings,fails,others\n";
+    for (const auto& r : rows) {
+        csv << ts << ',';
+        csvField(csv, r.mod);
+        csv << ',' << r.c->errors
+            << ',' << r.c->warnings
+            << ',' << r.c->fails
+            << ',' << r.c->others
+            << '\n';
+    }
+
+    const auto logPath = path("log");
+    std::error_code ec;
+    fs::create_directories(fs::path(logPath).parent_path(), ec);
+    if (ec) {
+        logger::error("WatchWriter failed to create {}: {}", fs::path(logPath).parent_path().string(), ec.message());
+        return;
+    }
+
+    replaceFile(logPath, log.str());
+    replaceFile(path("csv"), csv.str());
+}
+
+void Logwatch::WatchWriter::appendTimeline(const std::chrono::system_clock::time_point& at) {
+    timeline.append(std::chrono::duration_cast<std::chrono::milliseconds>(at.time_since_epoch()).count());
+}
+
+void Logwatch::WatchWriter::run(const std::stop_token& stop) {
+    while (true) {
+        std::shared_ptr<const CountsTable> table;
+        std::chrono::system_clock::time_point at;
+        bool snapshot = false, toTimeline = false;
+        {
+            std::unique_lock lock(_mutex_);
+            _wake_cv_.wait(lock, stop, [&] { return pending != nullptr; });
+
+            // Hold it back until the interval is up; newer tables keep replacing it meanwhile.
+            // Stopping skips the wait, the last one still gets written below.
+            _wake_cv_.wait_until(lock, stop, lastWriteAt + kMinInterval, [] { return false; });
+
+            if (!pending) {
+                if (stop.stop_requested()) return;
+                continue;
+            }
+            table = std::move(pending);
+            pending.reset();
+            at = pendingAt;
+            snapshot = pendingSnapshot;
+            toTimeline = pendingTimeline;
+        }
+
+        try {
+            if (snapshot) write(*table, at);
+            if (toTimeline) appendTimeline(at);
+        }
+        catch (const std::exception& e) {
+            logger::error("WatchWriter failed due to {}", e.what());
+        }
+        lastWriteAt = std::chrono::steady_clock::now();
+
+        if (stop.stop_requested()) return;
+    }
+}
+
+void Logwatch::WatchWriter::start() {
+    if (worker.joinable()) return;
+    worker = std::jthread([this](const std::stop_token& st) {
+        try {
+            run(st);
+        }
+        catch (const std::exception& e) {
+            logger::error("WatchWriter thread failed: {}", e.what());
+        }
+        catch (...) {
+            logger::error("WatchWriter thread failed for unknown reasons");
+        }
+    });
+}
+
+void Logwatch::WatchWriter::stop() {
+    if (!worker.joinable()) return;
+    worker.request_stop();
+    worker.join();
+}
+
+void Logwatch::WatchWriter::submit(std::shared_ptr<const CountsTable> table, const bool& snapshot, const bool& timeline) {
+    {
+        std::lock_guard lock(_mutex_);
+        pending = std::move(table);
+        pendingAt = std::chrono::system_clock::now();
+        pendingSnapshot = snapshot;
+        pendingTimeline = timeline;
+    }
+    _wake_cv_.notify_one();
+}